@@ -9,7 +9,20 @@
 #define StreamCom_H_
 
 #include "Arduino.h"
+
+#ifndef STREAM_COM_STATIC_ALLOCATION
+#define STREAM_COM_STATIC_ALLOCATION false
+#endif
+
+#if STREAM_COM_STATIC_ALLOCATION == true
+#include "StreamCom_List.h"
+#else
 #include "vector"
+#endif
+#include "StreamCom_Hmac.h"
+#include "StreamCom_Trace.h"
+#include "StreamCom_Task.h"
+#include "StreamCom_Frame.h"
 
 #ifndef STREAM_COM_DEFAULT_LIST_ENABLE
 #define STREAM_COM_DEFAULT_LIST_ENABLE true
@@ -27,8 +40,87 @@
 #define STREAM_COM_PARAM_DELIMITER ";"
 #endif
 
+#ifndef STREAM_COM_MAX_SERVICES
+#define STREAM_COM_MAX_SERVICES 32u
+#endif
+
+#ifndef STREAM_COM_MAX_CONNECTIONS
+#define STREAM_COM_MAX_CONNECTIONS 1u
+#endif
+
+#ifndef STREAM_COM_LINE_BUFFER_SIZE
+#define STREAM_COM_LINE_BUFFER_SIZE 80u
+#endif
+
+#ifndef STREAM_COM_RX_BUDGET
+#define STREAM_COM_RX_BUDGET 32u
+#endif
+
+#ifndef STREAM_COM_LINE_TIMEOUT_MS
+#define STREAM_COM_LINE_TIMEOUT_MS 1000u
+#endif
+
+#ifndef STREAM_COM_XON_XOFF_ENABLE
+#define STREAM_COM_XON_XOFF_ENABLE false
+#endif
+
+#define STREAM_COM_XON 0x11
+#define STREAM_COM_XOFF 0x13
+
+#ifndef STREAM_COM_SCHEDULER_SIZE
+#define STREAM_COM_SCHEDULER_SIZE 4u
+#endif
+
+#ifndef STREAM_COM_SCHEDULER_BUDGET_US
+#define STREAM_COM_SCHEDULER_BUDGET_US 2000u
+#endif
+
+#ifndef STREAM_COM_AUTH_ENABLE
+#define STREAM_COM_AUTH_ENABLE false
+#endif
+
+#ifndef STREAM_COM_AUTH_MAX_FAILURES
+#define STREAM_COM_AUTH_MAX_FAILURES 3u
+#endif
+
+#ifndef STREAM_COM_AUTH_LOCKOUT_MS
+#define STREAM_COM_AUTH_LOCKOUT_MS 30000u
+#endif
+
+#ifndef STREAM_COM_AUTH_CHALLENGE_SIZE
+#define STREAM_COM_AUTH_CHALLENGE_SIZE 16u
+#endif
+
+/** A session falls back to ACCESS_PUBLIC after this time without a command, 0 disables the timeout. */
+#ifndef STREAM_COM_AUTH_SESSION_TIMEOUT_MS
+#define STREAM_COM_AUTH_SESSION_TIMEOUT_MS 300000u
+#endif
+
+#ifndef STREAM_COM_STRING_SIZE
+#if STREAM_COM_AUTH_ENABLE == true
+#define STREAM_COM_STRING_SIZE 65u
+#else
+#define STREAM_COM_STRING_SIZE 32u
+#endif
+#endif
+
+#if STREAM_COM_AUTH_ENABLE == true
+#define STREAM_COM_AUTH_SERVICES 3u
+#else
+#define STREAM_COM_AUTH_SERVICES 0u
+#endif
+
+#if STREAM_COM_TRACE_ENABLE == true
+#define STREAM_COM_TRACE_SERVICES 2u
+#else
+#define STREAM_COM_TRACE_SERVICES 0u
+#endif
+
 #if STREAM_COM_DEFAULT_LIST_ENABLE == true
-#define STREAM_COM_DEFAULT_LIST_SIZE 3u
+#define STREAM_COM_DEFAULT_LIST_SIZE (6u + STREAM_COM_AUTH_SERVICES + STREAM_COM_TRACE_SERVICES)
+#if STREAM_COM_STATIC_ALLOCATION == true && STREAM_COM_MAX_SERVICES < STREAM_COM_DEFAULT_LIST_SIZE
+#error "STREAM_COM_MAX_SERVICES is smaller than the default list"
+#endif
 #endif
 
 /**
@@ -110,11 +202,119 @@ enum Types_e
     I64,    //!< Represents the data type int64_t.
     F,      //!< Represents the data type float.
     D,      //!< Represents the data type double.
-    STR,    //!< Represents the data type String.
+    STR,    //!< Represents the data type String (char[STREAM_COM_STRING_SIZE] with STREAM_COM_STATIC_ALLOCATION).
     RAW,    //!< Represents the data type Classes/Structs.
     NONE    //!< Represents no type or indicates that the type is not used.
 };
 
+/**
+ * @brief Enumeration representing the result of a received command.
+ *
+ * The result is reported to the stream and recorded by the trace (see STREAM_COM_TRACE_ENABLE).
+ */
+enum Result_e
+{
+    RESULT_OK = 0,            //!< The command was executed.
+    RESULT_UNKNOWN_TOKEN,     //!< No service with the token exists.
+    RESULT_EXEC_FAILED,       //!< The command could not be executed.
+    RESULT_ACCESS_DENIED,     //!< The session has not the access level of the service.
+    RESULT_EMPTY,             //!< An empty line was received.
+    RESULT_LINE_TOO_LONG,     //!< The line did not fit into the line buffer.
+    RESULT_PARAM_COUNT,       //!< Less parameters than configured were received.
+    RESULT_PARAM_FORMAT,      //!< A numeric parameter is not a number.
+    RESULT_PARAM_RANGE,       //!< A parameter is out of the range of its type or its CHECK_MIN/CHECK_MAX.
+    RESULT_PARAM_NOT_ALLOWED, //!< A parameter is not one of its CHECK_ONE_OF values.
+    RESULT_PARAM_TOO_LONG,    //!< A parameter is longer than its CHECK_MAX_LEN.
+    RESULT_PARAM_PATTERN,     //!< A parameter does not match its CHECK_PATTERN.
+    RESULT_QUEUE_FULL,        //!< No free slot in the scheduler for a deferred callback.
+    RESULT_BUSY               //!< The task of the service is still running.
+};
+
+/**
+ * @brief Flags for the execution of the callback of a service.
+ *
+ * @see Service_t
+ */
+enum ServiceFlag_e
+{
+    SERVICE_INLINE = 0x00,   //!< The callback is called directly in loop() when the command is received.
+    SERVICE_DEFERRED = 0x01, //!< The callback is queued and called by the scheduler in a later loop().
+    SERVICE_DEBOUNCE = 0x02  //!< The callback is called after no further command was received for the interval.
+};
+
+/**
+ * @brief Enumeration representing the access levels of StreamCom.
+ *
+ * Each service requires an access level. A command is only executed if the access level of the session is
+ * equal or higher than the access level of the service. The access level of a session is raised by a
+ * successful challenge-response login (see STREAM_COM_AUTH_ENABLE).
+ *
+ * @note Without STREAM_COM_AUTH_ENABLE the access level of the services is ignored.
+ *
+ * @see Service_t
+ */
+enum AccessLevel_e
+{
+    ACCESS_PUBLIC = 0, //!< Service can be used without login.
+    ACCESS_USER,       //!< Service needs a login with user rights.
+    ACCESS_ADMIN       //!< Service needs a login with admin rights.
+};
+
+/**
+ * @brief Flags of the checks of a parameter constraint.
+ *
+ * @see Constraint_t
+ */
+enum ConstraintCheck_e
+{
+    CHECK_NONE = 0x00,    //!< No check.
+    CHECK_MIN = 0x01,     //!< Numeric value must be >= min.
+    CHECK_MAX = 0x02,     //!< Numeric value must be <= max.
+    CHECK_ONE_OF = 0x04,  //!< Value must be one of the '|' separated values of oneOf.
+    CHECK_MAX_LEN = 0x08, //!< Text must not be longer than maxLength.
+    CHECK_PATTERN = 0x10  //!< Text must match the pattern.
+};
+
+/**
+ * @brief Structure representing the constraints of one parameter.
+ *
+ * All parameters of a command are checked before the first parameter is written. If one check fails,
+ * no variable is touched and the command is rejected with an error.
+ *
+ * @param checks    The active checks. Combination of ConstraintCheck_e flags.
+ * @param min       Minimum of a numeric parameter.
+ * @param max       Maximum of a numeric parameter.
+ * @param oneOf     Allowed values separated by '|', e.g. "ON|OFF" or "1|5|10". Numeric parameters are
+ *                  compared by value.
+ * @param maxLength Maximum number of characters of the parameter.
+ * @param pattern   Simple pattern the parameter has to match: '#' a digit, '@' a letter, '?' any character,
+ *                  '*' any sequence, '\' escapes the next character. Each other character matches itself.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * const Constraint_t pidLimits[] = {STREAMCOM_RANGE(0, 1000), STREAMCOM_RANGE(0.0, 10.0), STREAMCOM_NO_CHECK};
+ * const Constraint_t modeLimits[] = {STREAMCOM_ONE_OF("ON|OFF|AUTO")};
+ * const Constraint_t timeLimits[] = {STREAMCOM_PATTERN("##:##")};
+ * @endcode
+ *
+ * @see Service_t
+ */
+typedef struct
+{
+    uint8_t checks;
+    double min;
+    double max;
+    const char *oneOf;
+    uint16_t maxLength;
+    const char *pattern;
+} Constraint_t;
+
+#define STREAMCOM_NO_CHECK {CHECK_NONE, 0, 0, NULL, 0, NULL}
+#define STREAMCOM_RANGE(MIN, MAX) {CHECK_MIN | CHECK_MAX, (MIN), (MAX), NULL, 0, NULL}
+#define STREAMCOM_ONE_OF(VALUES) {CHECK_ONE_OF, 0, 0, (VALUES), 0, NULL}
+#define STREAMCOM_MAX_LEN(LEN) {CHECK_MAX_LEN, 0, 0, NULL, (LEN), NULL}
+#define STREAMCOM_PATTERN(PATTERN) {CHECK_PATTERN, 0, 0, NULL, 0, (PATTERN)}
+
 /**
  * @brief Structure representing a parameter list for a command in StreamCom.
  *
@@ -146,6 +346,29 @@ enum Types_e
  *                  The callback function should handle the desired logic and utilize the provided parameters to
  *                  accomplish the intended functionality.
  *
+ * @param accessLevel The access level needed to execute the command [Optional].
+ *                  If not configured, the service is public (ACCESS_PUBLIC). The access level is only checked
+ *                  if STREAM_COM_AUTH_ENABLE is set to true.
+ *
+ * @param constraints Array with one Constraint_t per parameter [Optional].
+ *                  If not configured, the parameters are only checked against their data type.
+ *
+ * @param flags     Execution of the callback as ServiceFlag_e flags [Optional].
+ *                  Deferred callbacks are queued to the scheduler and run after the command is parsed, so a slow
+ *                  callback does not delay the other streams. The queue holds STREAM_COM_SCHEDULER_SIZE jobs and
+ *                  each loop() runs callbacks for up to STREAM_COM_SCHEDULER_BUDGET_US.
+ *
+ * @param interval  Rate limit of the callback in ms [Optional].
+ *                  The callback runs at most once per interval. Commands received in between are coalesced to
+ *                  one call with the latest parameters. With SERVICE_DEBOUNCE, the callback runs once the
+ *                  commands paused for the interval. A service with interval is always deferred.
+ *
+ * @param task      A resumable callback [Optional].
+ *                  The task is started by the scheduler like a deferred callback and resumed by each loop()
+ *                  until it returns TASK_DONE. While it runs, further commands of the service are rejected.
+ *                  A task without parameters (like HELP and CATALOG) runs once per connection, so only the
+ *                  commands of the same connection are rejected. See StreamCom_Task.
+ *
  * Example usage:
  * @code{.cpp}
  * // Define a callback function for a command
@@ -174,10 +397,131 @@ typedef struct
     Types_e paramTypes[STREAM_COM_MAX_PARAMETER];
     uint32_t nParams;
     StreamCom_Callback callback;
+    AccessLevel_e accessLevel;
+    const Constraint_t *constraints;
+    uint8_t flags;
+    uint16_t interval;
+    StreamCom_Task task;
 
 } Service_t;
 
+/**
+ * @brief Structure representing the state of a service in a StreamCom instance.
+ *
+ * The state is kept in a list parallel to the service list, so a Service_t only holds its configuration
+ * and can be shared by several instances, like StreamCom_default_list.
+ */
+typedef struct
+{
+    uint32_t lastRun;    /**< Time of the last call of the callback, start of the rate limit. */
+    bool called;         /**< The callback was called at least once. */
+    bool signatureFirst; /**< The service is the first one with its parameter signature. */
+    uint16_t signature;  /**< Index of the parameter signature in the signature table of the catalog. */
+} ServiceState_t;
+
+#if STREAM_COM_STATIC_ALLOCATION == true
+using ServiceList = StreamComList<Service_t *, STREAM_COM_MAX_SERVICES>;
+using ServiceStateList = StreamComList<ServiceState_t, STREAM_COM_MAX_SERVICES>;
+#else
 using ServiceList = std::vector<Service_t *>;
+using ServiceStateList = std::vector<ServiceState_t>;
+#endif
+
+/**
+ * @brief Structure representing the memory usage of a StreamCom instance.
+ *
+ * The peak values are the highest usage since the start, they show how much of the configured
+ * capacities is really needed.
+ *
+ * @see StreamCom::getMemoryReport
+ */
+typedef struct
+{
+    uint16_t instanceSize;     /**< sizeof(StreamCom), without the heap of the service list. */
+    uint16_t connectionSize;   /**< sizeof(Connection_t), included STREAM_COM_MAX_CONNECTIONS times. */
+    uint16_t services;         /**< Number of services. */
+    uint16_t servicesCapacity; /**< Capacity of the service list. */
+    uint16_t servicesPeak;     /**< Highest number of services. */
+    uint16_t linePeak;         /**< Longest received line, of STREAM_COM_LINE_BUFFER_SIZE - 1. */
+    uint8_t jobsPeak;          /**< Highest number of used scheduler slots, of STREAM_COM_SCHEDULER_SIZE. */
+    bool staticAllocation;     /**< StreamCom does not allocate memory (STREAM_COM_STATIC_ALLOCATION). */
+} MemoryReport_t;
+
+/**
+ * @brief Structure representing a stream attached to StreamCom.
+ *
+ * Each attached stream has its own line buffer and session state. The service list is shared between
+ * all connections, so the memory only grows with the number of connections (STREAM_COM_MAX_CONNECTIONS).
+ *
+ * @see StreamCom::attach
+ */
+typedef struct
+{
+    Stream *stream;                         /**< The attached stream. NULL if the connection is free. */
+    char line[STREAM_COM_LINE_BUFFER_SIZE]; /**< Buffer of the received line. */
+    uint16_t lineLen;                       /**< Number of received characters of the line. */
+    bool overflow;                          /**< The line is longer than the line buffer. */
+    uint32_t lastRx;                        /**< Time of the last received character. */
+    int txCapacity;                         /**< Largest free TX space seen, i.e. the TX buffer size. */
+    bool txPacing;                          /**< The output is paced by availableForWrite(). */
+    bool txPaused;                          /**< The receiver sent XOFF. */
+#if STREAM_COM_AUTH_ENABLE == true
+    AccessLevel_e accessLevel;                         /**< The access level of the session. */
+    uint8_t challenge[STREAM_COM_AUTH_CHALLENGE_SIZE]; /**< The last created challenge. */
+    bool challengeValid;                               /**< The challenge is not used yet. */
+    uint8_t authFailures;                              /**< Number of failed login attempts. */
+    uint32_t lockoutStart;                             /**< Start time of the login lockout. */
+    uint32_t lastCommand;                              /**< Time of the last command, for the session timeout. */
+#endif
+#if STREAM_COM_FRAMING_ENABLE == true
+    Framing_e framing;       /**< The transport of the connection. */
+    StreamComCobs_t cobs;    /**< The decoder of the received frame. */
+    uint16_t crc;            /**< The CRC of the received frame. */
+    FrameStats_t frameStats; /**< The counters of the received frames. */
+#endif
+} Connection_t;
+
+/**
+ * @brief Definition of a hook to check if a stream can send.
+ *
+ * The hook allows to add hardware flow control, e.g. to check the CTS line of an UART.
+ *
+ * @param stream The stream which wants to send.
+ * @return True if the receiver is ready, False otherwise.
+ *
+ * @see StreamCom::setTxReadyHook
+ */
+typedef bool (*StreamCom_TxReadyHook)(Stream *stream);
+
+/**
+ * @brief Print which only counts the printed characters.
+ *
+ * Used to get the size of an output before it is sent.
+ */
+class StreamComPrintCounter : public Print
+{
+public:
+    StreamComPrintCounter(void) : count(0) {}
+    size_t write(uint8_t) { count++; return 1; }
+    int count; /**< Number of printed characters. */
+};
+
+/**
+ * @brief Structure representing a queued callback of the scheduler.
+ *
+ * A job holds its slot while its callback waits for its call or its task runs. A new command of the
+ * service is coalesced into a waiting job. The rate limit is kept in the state of the service (ServiceState_t).
+ * A task without parameters has one job per connection.
+ */
+typedef struct
+{
+    Service_t *service;       /**< The service of the callback. NULL if the slot is free. */
+    Connection_t *connection; /**< The connection of the latest command. */
+    uint32_t due;             /**< Time when the callback has to run. */
+    bool pending;             /**< The callback waits for its call. */
+    bool running;             /**< The task of the service yielded and has to be resumed. */
+    StreamComTask_t task;     /**< The state of the task. */
+} Job_t;
 
 /**
  * @brief class to communicate over a stream.
@@ -192,6 +536,9 @@ public:
 
     /**
      * @brief main loop for the StreamCom class.
+     *
+     * All attached streams are polled round robin. Each stream can read up to STREAM_COM_RX_BUDGET bytes
+     * per loop, so a busy stream can not block the others.
      */
     void loop(void);
 
@@ -203,11 +550,121 @@ public:
      */
     void init(Stream &stream, Service_t *paramList, uint16_t size);
 
+    /**
+     * @brief Attaches a further stream to StreamCom.
+     *
+     * All attached streams share the same service list. Responses are only sent to the stream the
+     * command was received from.
+     *
+     * @param stream The stream to attach.
+     * @return True if the stream is attached, False if all STREAM_COM_MAX_CONNECTIONS are in use.
+     */
+    bool attach(Stream &stream);
+
+    /**
+     * @brief Detaches a stream from StreamCom.
+     * @param stream The stream to detach.
+     */
+    void detach(Stream &stream);
+
+    /**
+     * @brief Gets the quantity of attached streams.
+     * @return The number of attached streams.
+     */
+    uint8_t getConnectionQuantity(void);
+
     /**
      * @brief Prints the help information.
+     *
+     * The whole help is sent at once. The HELP service uses printHelpPaced() instead.
      */
     void printHelp(void);
 
+    /**
+     * @brief Prints the help information as far as the stream can take it without blocking.
+     *
+     * Each call prints the next services which fit into the free TX space of the stream and
+     * continues at the saved cursor on the next call.
+     *
+     * @param stream The stream to print the help.
+     * @param task The state of the task, task->counter is the cursor.
+     * @return TASK_YIELD if services are left, TASK_DONE if the help is complete.
+     */
+    TaskState_e printHelpPaced(Stream &stream, StreamComTask_t *task);
+
+    /**
+     * @brief Prints the compact catalog of the services as far as the stream can take it without blocking.
+     *
+     * The catalog is meant for host tools, which can cache it and skip the download if the hash of the
+     * service set (see getServiceHash()) did not change:
+     * @code
+     * #CATALOG <services>;<hash>
+     * T;<signature 0>;<signature 1>;...
+     * <prefix><suffix>;<signature>;<access level>;<flags>
+     * #END
+     * @endcode
+     * The T line is the table of the different parameter signatures, one character per parameter
+     * (b I8, s I16, i I32, l I64, f F, d D, S STR, R RAW, - NONE). Each service line holds the
+     * index of its signature. The token is delta encoded: prefix is the number of leading characters
+     * shared with the token of the line before (0-9, A-Z for 10-35), followed by the rest of the token.
+     *
+     * @param stream The stream to print the catalog.
+     * @param task The state of the task, task->counter is the cursor.
+     * @return TASK_YIELD if lines are left, TASK_DONE if the catalog is complete.
+     */
+    TaskState_e printCatalogPaced(Stream &stream, StreamComTask_t *task);
+
+    /**
+     * @brief Gets the hash of the service set.
+     *
+     * The hash covers the token, the parameter types, the access level and the flags of each service and
+     * does not depend on the order of the services. It is updated when a service is added or deleted.
+     * Changes of a Service_t after it was added are not covered.
+     *
+     * @return The hash of the service set.
+     */
+    uint32_t getServiceHash(void);
+
+    /**
+     * @brief Checks if a stream can send the given number of bytes without blocking.
+     *
+     * The check considers the free TX space (if the stream reports it), XON/XOFF
+     * (STREAM_COM_XON_XOFF_ENABLE) and the TX ready hook.
+     *
+     * @param stream The stream to check.
+     * @param bytes The number of bytes to send.
+     * @return True if the bytes can be sent, False otherwise.
+     */
+    bool txReady(Stream *stream, int bytes);
+
+    /**
+     * @brief Enables or disables the pacing of the output of a stream.
+     *
+     * Pacing is enabled by attach() if the stream reports free TX space by availableForWrite().
+     *
+     * @param stream The attached stream.
+     * @param pacing True to pace the output by availableForWrite().
+     */
+    void setTxPacing(Stream &stream, bool pacing);
+
+    /**
+     * @brief Sets a hook for hardware flow control.
+     * @param hook The hook, NULL to remove it.
+     */
+    void setTxReadyHook(StreamCom_TxReadyHook hook);
+
+    /**
+     * @brief Gets the memory usage of the instance.
+     * @param report The memory usage.
+     */
+    void getMemoryReport(MemoryReport_t &report);
+
+    /**
+     * @brief Prints the memory usage of the instance.
+     * @param out The destination of the report.
+     */
+    void printMemoryReport(Print &out);
+
     /**
      * @brief Gets the quantity of services.
      * @return The number of services.
@@ -216,6 +673,10 @@ public:
 
     /**
      * @brief Adds a service to the parameter list.
+     *
+     * With STREAM_COM_STATIC_ALLOCATION the list holds STREAM_COM_MAX_SERVICES services. If it is full,
+     * the service is not added and an error is printed.
+     *
      * @param service The service to be added.
      */
     void addService(Service_t& service);
@@ -232,35 +693,211 @@ public:
      */
     void deleteService(const char *service_token);
 
+#if STREAM_COM_FRAMING_ENABLE == true
+    /**
+     * @brief Sets the transport of an attached stream.
+     *
+     * With FRAMING_COBS each command is received as COBS encoded frame with a CRC-16 (high byte first)
+     * after the text of the command and a 0x00 at the end. Frames with a wrong CRC or encoding are
+     * dropped and counted, the next frame starts after the next 0x00. The responses are sent as frames
+     * of up to STREAM_COM_FRAME_SIZE bytes.
+     *
+     * @param stream The attached stream.
+     * @param framing The transport of the stream.
+     */
+    void setFraming(Stream &stream, Framing_e framing);
+
+    /**
+     * @brief Gets the counters of the received frames of a stream.
+     * @param stream The attached stream.
+     * @param stats The counters of the stream.
+     * @return True if the stream is attached, False otherwise.
+     */
+    bool getFrameStats(Stream &stream, FrameStats_t &stats);
+#endif
+
+#if STREAM_COM_AUTH_ENABLE == true
+    /**
+     * @brief Sets the shared secret for the challenge-response login.
+     * @param key The shared secret. The key is not copied and has to stay valid.
+     * @param keyLen The length of the shared secret.
+     * @param level The access level granted after a successful login.
+     */
+    void setAuthKey(const uint8_t *key, uint8_t keyLen, AccessLevel_e level = ACCESS_ADMIN);
+
+    /**
+     * @brief Creates a new challenge and prints it as hex string to the stream.
+     *
+     * The client has to answer with the hex string of HMAC-SHA256(key, challenge). Each challenge
+     * can only be used for one login attempt.
+     */
+    void requestChallenge(void);
+
+    /**
+     * @brief Checks the response to the last challenge.
+     * @param response The HMAC-SHA256 of the challenge as hex string.
+     * @return True if the login was successful, False otherwise.
+     */
+    bool authenticate(const char *response);
+
+    /**
+     * @brief Drops the access level of the session back to ACCESS_PUBLIC.
+     */
+    void logout(void);
+
+    /**
+     * @brief Gets the access level of the session of the current command.
+     * @return The access level.
+     */
+    AccessLevel_e getAccessLevel(void);
+#endif
+
+#if STREAM_COM_TRACE_ENABLE == true
+    /**
+     * @brief Prints all recorded commands.
+     * @param out The destination of the trace, e.g. the stream or a file.
+     */
+    void dumpTrace(Print &out);
+
+    /**
+     * @brief Deletes all recorded commands.
+     */
+    void clearTrace(void);
+#endif
+
 private:
     /**
-     * @brief Splits a string using a separator.
+     * @brief Reads the available bytes of a connection into its line buffer.
+     * @param connection The connection to poll.
+     */
+    void pollConnection(Connection_t &connection);
+
+    /**
+     * @brief Parses and executes the received line of a connection.
+     * @param connection The connection of the line.
+     */
+    void processLine(Connection_t &connection);
+
+#if STREAM_COM_FRAMING_ENABLE == true
+    /**
+     * @brief Decodes a received byte of a framed connection.
+     *
+     * A complete frame with valid CRC is passed to processLine().
+     *
+     * @param connection The connection of the byte.
+     * @param c The received byte.
+     */
+    void receiveFrame(Connection_t &connection, uint8_t c);
+
+    /**
+     * @brief Resets the decoder of a framed connection for the next frame.
+     * @param connection The connection to reset.
+     */
+    void resetFrame(Connection_t &connection);
+#endif
+
+    /**
+     * @brief Selects the connection of a command or job and its output stream.
+     * @param connection The connection.
+     */
+    void beginOutput(Connection_t &connection);
+
+    /**
+     * @brief Sends the output of a framed connection.
+     * @param connection The connection.
+     */
+    void endOutput(Connection_t &connection);
+
+    /**
+     * @brief Searches the service of a command and executes it.
+     * @param str The trimmed command line.
+     * @return The result of the command.
+     */
+    Result_e dispatch(char *str);
+
+    /**
+     * @brief Reports the result of a command to the stream.
+     * @param result The result of the command.
+     * @param token The token of the command.
+     */
+    void printResult(Result_e result, const char *token);
+
+    /**
+     * @brief Reports an invalid parameter to the stream.
+     * @param reason The reason why the parameter is invalid.
+     */
+    void printParamError(const __FlashStringHelper *reason);
+
+    /**
+     * @brief Prints the constraints of a parameter.
+     * @param out The destination of the output.
+     * @param constraint The constraint to print.
+     */
+    void printConstraint(Print &out, const Constraint_t &constraint);
+
+    /**
+     * @brief Prints one part of the help information.
+     * @param out The destination of the output.
+     * @param part 0 for the header, n for the n-th service.
+     */
+    void printHelpPart(Print &out, uint16_t part);
+
+    /**
+     * @brief Prints one line of the catalog.
+     * @param out The destination of the output.
+     * @param part 0 for the header, 1 for the signature table, n + 1 for the n-th service, else the end.
+     */
+    void printCatalogPart(Print &out, uint16_t part);
+
+    /**
+     * @brief Searches the connection of a stream.
+     * @param stream The stream.
+     * @return The connection, NULL if the stream is not attached.
+     */
+    Connection_t *findConnection(Stream *stream);
+
+    /**
+     * @brief Splits a string at the first delimiter.
+     *
+     * The delimiter is replaced by the string termination in place.
+     *
      * @param strToSplit The string to split.
-     * @param strToStore The destination string to store the split parts.
-     * @param delimiter The delimiter character.
+     * @param delimiter The delimiter string.
+     * @return The start of the part after the delimiter, NULL if there is no delimiter.
      */
-    void stringSplit(String *strToSplit, String *strToStore, const char *delimiter);
+    char *stringSplit(char *strToSplit, const char *delimiter);
 
     /**
-     * @brief Checks if a string is valid.
+     * @brief Checks if a string is valid and trims it in place.
      * @param readString The string to check.
-     * @return True if the string is valid, False otherwise.
+     * @return The trimmed string if it is valid, NULL otherwise.
      */
-    bool stringVerify(String *readString);
+    char *stringVerify(char *readString);
 
     /**
      * @brief Splits a parameter string into individual parameters and stores them in the parameter list.
      * @param paramStr The parameter string to split.
      * @param paramListIdx The index in the parameter list to store the parameters in.
-     * @return True if the split was successful, False otherwise.
+     * @return RESULT_OK if the split was successful, the error otherwise.
+     */
+    Result_e splitParameter(char *paramStr, uint16_t paramListIdx);
+
+    /**
+     * @brief Checks all parameters against their type and constraints.
+     *
+     * The numeric values are stored, so the conversion does not parse the text again.
+     *
+     * @param paramListIdx The index in the parameter list.
+     * @return RESULT_OK if all parameters are valid, the error of the first invalid parameter otherwise.
      */
-    bool splitParameter(String *paramStr, uint8_t paramListIdx);
+    Result_e validateParameter(uint16_t paramListIdx);
 
     /**
      * @brief Converts a parameter to the appropriate type.
      * @param paramListIdx The index of the parameter in the parameter list.
+     * @return True if all parameters were written, False if a parameter pointer is missing.
      */
-    void convertParameter(uint8_t paramListIdx);
+    bool convertParameter(uint16_t paramListIdx);
 
     /**
      * @brief Converts a parameter to the specified type.
@@ -276,35 +913,134 @@ private:
      * @brief Executes a command.
      * @param paramStr The command string.
      * @param paramListIdx The index of the parameter in the parameter list.
-     * @return True if the command was executed successfully, False otherwise.
+     * @return RESULT_OK if the command was executed successfully, the error otherwise.
      */
-    bool executeCommand(String *paramStr, uint8_t paramListIdx);
+    Result_e executeCommand(char *paramStr, uint16_t paramListIdx);
 
     /**
      * @brief Calls the callback function for a parameter.
      * @param paramListIdx The index of the parameter in the parameter list.
      */
-    void executeCallback(uint8_t paramListIdx);
+    void executeCallback(uint16_t paramListIdx);
+
+    /**
+     * @brief Finds the job of a service or a free slot for it, without taking the slot.
+     * @param entry The service of the callback.
+     * @param job Set to the job of the service or to the free slot.
+     * @return RESULT_OK if a job is found, RESULT_BUSY if the task of the job is running,
+     *         RESULT_QUEUE_FULL otherwise.
+     */
+    Result_e findJob(Service_t *entry, Job_t **job);
+
+    /**
+     * @brief Queues the callback of a service to the scheduler.
+     * @param entry The service of the callback.
+     * @param job The job found by findJob().
+     */
+    void scheduleCallback(Service_t *entry, Job_t *job);
+
+    /**
+     * @brief Calls the due callbacks and resumes the running tasks within STREAM_COM_SCHEDULER_BUDGET_US.
+     */
+    void runScheduler(void);
+
+    /**
+     * @brief Calls the callback or resumes the task of a job.
+     * @param job The job to run.
+     */
+    void runJob(Job_t &job);
+
+    /**
+     * @brief Frees the slot of a job and stops its task.
+     * @param job The job to free.
+     */
+    void freeJob(Job_t &job);
 
     /**
      * @brief Checks if parameters are available for a given index.
      * @param paramListIdx The index of the parameter in the parameter list.
      * @return True if parameters are available, otherwise False.
      */
-    bool paramsAvailable(uint8_t paramListIdx);
+    bool paramsAvailable(uint16_t paramListIdx);
 
     int16_t serviceExists(const char* serviceToken);
+
+    /**
+     * @brief Appends a service to the service list and updates the hash and the signature table.
+     * @param service The service to append.
+     * @return True if the service is appended, False if the list is full.
+     */
+    bool appendService(Service_t &service);
+
+    /**
+     * @brief Updates the signature table before a service is deleted.
+     *
+     * If the service is the first one with its signature, the next service with the signature takes over.
+     * Without one, the signature is removed and the following signatures move forward.
+     *
+     * @param service_entry The index of the service which is deleted.
+     */
+    void removeSignature(uint16_t service_entry);
+
+    /**
+     * @brief Gets the state of a service.
+     * @param service The service.
+     * @return The state, NULL if the service is not in the service list.
+     */
+    ServiceState_t *serviceState(const Service_t *service);
+
+#if STREAM_COM_AUTH_ENABLE == true
+    /**
+     * @brief Checks if the login is locked because of too many failed attempts.
+     * @return True if locked, False otherwise.
+     */
+    bool authLocked(void);
+#endif
 private:
-    ServiceList m_serviceList;                   /**< Parameter list. */
-    uint16_t m_list_size;                      /**< The size of the parameter list. */
-    String m_params[STREAM_COM_MAX_PARAMETER]; /**< The parameters. */
+    ServiceList m_serviceList;                              /**< Parameter list. */
+    ServiceStateList m_serviceStates;                       /**< The state of each service, parallel to m_serviceList. */
+    uint16_t m_list_size;                                   /**< The size of the parameter list. */
+    uint32_t m_serviceHash;                                 /**< The hash of the service set. */
+    uint16_t m_signatureCount;                              /**< Number of parameter signatures in the catalog. */
+    uint16_t m_servicesPeak;                                /**< Highest number of services. */
+    uint16_t m_linePeak;                                    /**< Longest received line. */
+    uint8_t m_jobsPeak;                                     /**< Highest number of used scheduler slots. */
+    const char *m_params[STREAM_COM_MAX_PARAMETER];         /**< The parameters. Pointers into the line buffer. */
+    union
+    {
+        int64_t l;
+        double d;
+    } m_values[STREAM_COM_MAX_PARAMETER];                   /**< The checked numeric values of the parameters. */
+    uint8_t m_errorParam;                                   /**< The number of the invalid parameter. */
+    Job_t m_jobs[STREAM_COM_SCHEDULER_SIZE];                /**< The jobs of the scheduler. */
+    uint8_t m_nextJob;                                      /**< The job to check first. */
+    Connection_t m_connections[STREAM_COM_MAX_CONNECTIONS]; /**< The attached streams. */
+    Connection_t *m_connection;                             /**< The connection of the current command. */
+    uint8_t m_nextConnection;                               /**< The connection to poll first. */
+    StreamCom_TxReadyHook m_txReadyHook;                    /**< Hook for hardware flow control. */
 
     const char *m_cmdDelimiter;   /**< The delimiter for commands. */
     const char *m_paramDelimiter; /**< The delimiter for parameters. */
-    Stream *m_stream;             /**< The stream for communication. */
+    Stream *m_stream;             /**< The stream of the current command. */
+
+#if STREAM_COM_AUTH_ENABLE == true
+    const uint8_t *m_authKey;  /**< The shared secret. */
+    uint8_t m_authKeyLen;      /**< The length of the shared secret. */
+    AccessLevel_e m_authLevel; /**< The access level granted by a login. */
+#endif
+
+#if STREAM_COM_TRACE_ENABLE == true
+    StreamComTrace m_trace; /**< Record of the received commands. */
+#endif
+
+#if STREAM_COM_FRAMING_ENABLE == true
+    StreamComFramer m_framer; /**< Output of the framed connections. */
+#endif
 };
 
+#if STREAM_COM_DEFAULT_LIST_ENABLE == true
 extern Service_t StreamCom_default_list[STREAM_COM_DEFAULT_LIST_SIZE];
+#endif
 extern StreamCom *mThis;
 
 #endif /* StreamCom_H_ */
@@ -0,0 +1,129 @@
+/*
+ * StreamCom_Frame.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ */
+
+#ifndef StreamCom_Frame_H_
+#define StreamCom_Frame_H_
+
+#include "Arduino.h"
+
+#ifndef STREAM_COM_FRAMING_ENABLE
+#define STREAM_COM_FRAMING_ENABLE false
+#endif
+
+#ifndef STREAM_COM_FRAME_SIZE
+#define STREAM_COM_FRAME_SIZE 64u
+#endif
+
+/** Start value of the CRC-16/CCITT-FALSE. */
+#define STREAM_COM_CRC16_INIT 0xFFFFu
+
+/** Size of the CRC at the end of each frame. */
+#define STREAM_COM_CRC16_SIZE 2u
+
+/** The byte which ends each frame. */
+#define STREAM_COM_FRAME_DELIMITER 0x00
+
+/**
+ * @brief Enumeration representing the transport of a connection.
+ *
+ * @see StreamCom::setFraming
+ */
+enum Framing_e
+{
+    FRAMING_NONE = 0, //!< Text lines ended by CR or LF.
+    FRAMING_COBS      //!< COBS encoded frames with CRC-16, ended by 0x00.
+};
+
+/**
+ * @brief Structure representing the counters of the received frames of a connection.
+ */
+typedef struct
+{
+    uint32_t frames;        /**< Number of valid frames. */
+    uint32_t crcErrors;     /**< Number of frames with wrong CRC. */
+    uint32_t framingErrors; /**< Number of frames with invalid COBS encoding or without CRC. */
+    uint32_t overflows;     /**< Number of frames larger than the line buffer. */
+} FrameStats_t;
+
+/**
+ * @brief Structure representing the state of the COBS decoder of a frame.
+ */
+typedef struct
+{
+    uint8_t code; /**< The last code byte, 0 at the start of a frame. */
+    uint8_t left; /**< Number of data bytes left in the current block. */
+} StreamComCobs_t;
+
+/**
+ * @brief Updates a CRC-16/CCITT-FALSE (polynomial 0x1021) with one byte.
+ *
+ * The CRC is calculated with a table of 256 entries in the flash. A CRC calculated over the data and its
+ * own CRC (high byte first) is 0.
+ *
+ * @param crc The CRC so far, STREAM_COM_CRC16_INIT at the start.
+ * @param data The next byte.
+ * @return The updated CRC.
+ */
+uint16_t StreamCom_crc16Update(uint16_t crc, uint8_t data);
+
+/**
+ * @brief Decodes one byte of a COBS frame.
+ *
+ * The frame delimiter is not passed to the decoder. Each byte gives at most one decoded byte, so the
+ * frame is decoded while it is received.
+ *
+ * @param cobs The state of the decoder, zeroed at the start of a frame.
+ * @param data The received byte, not 0x00.
+ * @return The decoded byte, -1 if the byte gives no data.
+ */
+int16_t StreamCom_cobsDecode(StreamComCobs_t *cobs, uint8_t data);
+
+/**
+ * @brief Stream which sends the printed output as COBS frames with CRC-16.
+ *
+ * The output is collected up to STREAM_COM_FRAME_SIZE bytes and sent as one frame if the buffer is full
+ * or flush() is called. StreamCom flushes the frame after each command and after each step of a task.
+ * Input is only received as frames by StreamCom, so the framer has nothing to read.
+ */
+class StreamComFramer : public Stream
+{
+public:
+    /**
+     * @brief constructor for the StreamComFramer class.
+     */
+    StreamComFramer(void);
+
+    /**
+     * @brief Sets the stream which transports the frames.
+     * @param stream The stream of the connection.
+     */
+    void begin(Stream *stream);
+
+    /**
+     * @brief Gets the stream which transports the frames.
+     * @return The stream of the connection.
+     */
+    Stream *getStream(void);
+
+    /**
+     * @brief Sends the collected output as one frame.
+     */
+    void flush(void);
+
+    size_t write(uint8_t data);
+    int availableForWrite(void);
+    int available(void);
+    int read(void);
+    int peek(void);
+
+private:
+    Stream *m_stream;                                                /**< The stream of the connection. */
+    uint8_t m_buffer[STREAM_COM_FRAME_SIZE + STREAM_COM_CRC16_SIZE]; /**< The output of the frame. */
+    uint16_t m_len;                                                  /**< Number of collected bytes. */
+};
+
+#endif /* StreamCom_Frame_H_ */
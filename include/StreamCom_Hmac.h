@@ -0,0 +1,74 @@
+/*
+ * StreamCom_Hmac.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ */
+
+#ifndef StreamCom_Hmac_H_
+#define StreamCom_Hmac_H_
+
+#include "Arduino.h"
+
+#define STREAM_COM_SHA256_BLOCK_SIZE 64u
+#define STREAM_COM_SHA256_DIGEST_SIZE 32u
+
+/**
+ * @brief Context of an running SHA-256 calculation.
+ *
+ * The context allows to feed the data in several pieces into the hash calculation.
+ * It has to be initialized with StreamCom_sha256Init() before the first usage.
+ */
+typedef struct
+{
+    uint32_t state[8];                           /**< Intermediate hash value. */
+    uint64_t length;                             /**< Number of processed bytes. */
+    uint8_t block[STREAM_COM_SHA256_BLOCK_SIZE]; /**< Buffer for an incomplete block. */
+    uint8_t blockLen;                            /**< Number of bytes in the block buffer. */
+} StreamCom_Sha256_t;
+
+/**
+ * @brief Initializes a SHA-256 context.
+ * @param ctx The context to initialize.
+ */
+void StreamCom_sha256Init(StreamCom_Sha256_t *ctx);
+
+/**
+ * @brief Feeds data into a SHA-256 calculation.
+ * @param ctx The context of the calculation.
+ * @param data The data to hash.
+ * @param len The number of bytes of data.
+ */
+void StreamCom_sha256Update(StreamCom_Sha256_t *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Finishes a SHA-256 calculation.
+ * @param ctx The context of the calculation.
+ * @param digest Destination of the 32 byte hash value.
+ */
+void StreamCom_sha256Final(StreamCom_Sha256_t *ctx, uint8_t *digest);
+
+/**
+ * @brief Calculates the HMAC-SHA256 of a message.
+ * @param key The shared secret.
+ * @param keyLen The length of the shared secret.
+ * @param msg The message to authenticate.
+ * @param msgLen The length of the message.
+ * @param mac Destination of the 32 byte message authentication code.
+ */
+void StreamCom_hmacSha256(const uint8_t *key, size_t keyLen, const uint8_t *msg, size_t msgLen, uint8_t *mac);
+
+/**
+ * @brief Compares two buffers in constant time.
+ *
+ * The runtime only depends on the length of the buffers and not on their content. This prevents
+ * an attacker to guess a secret byte by byte by measuring the response time.
+ *
+ * @param a First buffer.
+ * @param b Second buffer.
+ * @param len The number of bytes to compare.
+ * @return True if both buffers are equal, False otherwise.
+ */
+bool StreamCom_constTimeEquals(const uint8_t *a, const uint8_t *b, size_t len);
+
+#endif /* StreamCom_Hmac_H_ */
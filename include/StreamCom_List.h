@@ -0,0 +1,69 @@
+/*
+ * StreamCom_List.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ */
+
+#ifndef StreamCom_List_H_
+#define StreamCom_List_H_
+
+#include "Arduino.h"
+
+/**
+ * @brief List with a fixed capacity, used instead of std::vector by STREAM_COM_STATIC_ALLOCATION.
+ *
+ * The items are stored in the object itself, so the list never allocates memory. Only the part of the
+ * std::vector interface which is used by StreamCom is provided.
+ *
+ * @tparam T The type of the items.
+ * @tparam N The capacity of the list.
+ */
+template <typename T, uint16_t N>
+class StreamComList
+{
+public:
+    StreamComList(void) : m_size(0) {}
+
+    /**
+     * @brief Appends an item.
+     * @param item The item to append.
+     * @return True if the item is appended, False if the list is full.
+     */
+    bool push_back(const T &item)
+    {
+        if (m_size >= N)
+        {
+            return false;
+        }
+        m_items[m_size++] = item;
+        return true;
+    }
+
+    /**
+     * @brief Removes an item and moves the following items forward.
+     * @param pos The item to remove.
+     * @return The item after the removed one.
+     */
+    T *erase(T *pos)
+    {
+        for (T *next = pos + 1; next < end(); next++)
+        {
+            *(next - 1) = *next;
+        }
+        m_size--;
+        return pos;
+    }
+
+    T *begin(void) { return m_items; }
+    T *end(void) { return m_items + m_size; }
+    uint16_t size(void) const { return m_size; }
+    uint16_t capacity(void) const { return N; }
+    T &operator[](uint16_t index) { return m_items[index]; }
+
+private:
+    T m_items[N];     /**< The items. */
+    uint16_t m_size;  /**< Number of items. */
+};
+
+#endif /* StreamCom_List_H_ */
@@ -0,0 +1,265 @@
+/*
+ * StreamCom_Task.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ */
+
+#ifndef StreamCom_Task_H_
+#define StreamCom_Task_H_
+
+#include "Arduino.h"
+
+/*Coroutine frames are allocated on the heap, so they are not used by STREAM_COM_STATIC_ALLOCATION*/
+#if defined(__cpp_impl_coroutine) && defined(__has_include) && \
+    !(defined(STREAM_COM_STATIC_ALLOCATION) && STREAM_COM_STATIC_ALLOCATION == true)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define STREAM_COM_COROUTINE_SUPPORT true
+#endif
+#endif
+
+#ifndef STREAM_COM_COROUTINE_SUPPORT
+#define STREAM_COM_COROUTINE_SUPPORT false
+#endif
+
+/**
+ * @brief Checks if a stream can send the given number of bytes without blocking.
+ *
+ * Uses the flow control of the active StreamCom instance (see StreamCom::txReady).
+ *
+ * @param stream The stream to check.
+ * @param bytes The number of bytes to send.
+ * @return True if the bytes can be sent, False otherwise.
+ */
+bool StreamCom_txReady(Stream *stream, int bytes);
+
+/**
+ * @brief Enumeration representing the state of a resumable task.
+ */
+enum TaskState_e
+{
+    TASK_DONE = 0, //!< The task is finished.
+    TASK_YIELD     //!< The task waits and has to be resumed in a later loop().
+};
+
+#if STREAM_COM_COROUTINE_SUPPORT == true
+/**
+ * @brief Return type of a C++20 coroutine used as StreamCom task.
+ *
+ * The coroutine is created suspended and resumed by the scheduler of StreamCom. It can suspend with
+ * co_await StreamComYield{}, StreamComWaitWrite{stream, bytes} or StreamComDelay{ms}.
+ *
+ * @see STREAMCOM_COROUTINE_TASK
+ */
+struct StreamComCoroutine
+{
+    struct promise_type
+    {
+        Stream *waitStream = nullptr; /**< Stream to wait for free TX space. */
+        int waitBytes = 0;            /**< Needed free TX space. */
+        uint32_t wakeAt = 0;          /**< Time to resume after a delay. */
+        bool sleeping = false;        /**< The coroutine waits for wakeAt. */
+
+        StreamComCoroutine get_return_object() { return StreamComCoroutine{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() {}
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+/** Suspends the coroutine until the next loop(). */
+struct StreamComYield
+{
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<>) const noexcept {}
+    void await_resume() const noexcept {}
+};
+
+/** Suspends the coroutine until the stream can take the given number of bytes. */
+struct StreamComWaitWrite
+{
+    Stream *stream;
+    int bytes;
+
+    bool await_ready() const { return StreamCom_txReady(stream, bytes); }
+    void await_suspend(std::coroutine_handle<StreamComCoroutine::promise_type> h) const
+    {
+        h.promise().waitStream = stream;
+        h.promise().waitBytes = bytes;
+    }
+    void await_resume() const noexcept {}
+};
+
+/** Suspends the coroutine for the given time in ms. */
+struct StreamComDelay
+{
+    uint32_t ms;
+
+    bool await_ready() const noexcept { return ms == 0; }
+    void await_suspend(std::coroutine_handle<StreamComCoroutine::promise_type> h) const
+    {
+        h.promise().wakeAt = millis() + ms;
+        h.promise().sleeping = true;
+    }
+    void await_resume() const noexcept {}
+};
+#endif
+
+/**
+ * @brief Structure representing the state of a resumable task.
+ *
+ * Local variables of a task are lost when it yields. Values which are needed after a yield have to be
+ * stored in counter or in a buffer referenced by user.
+ */
+typedef struct
+{
+    uint16_t line;    /**< Resume point of the task. 0 at the first call. */
+    uint32_t timer;   /**< Start time of STREAMCOM_TASK_DELAY. */
+    uint32_t counter; /**< Free to use by the task, 0 at the first call. */
+    void *user;       /**< Free to use by the task, NULL at the first call. */
+#if STREAM_COM_COROUTINE_SUPPORT == true
+    std::coroutine_handle<StreamComCoroutine::promise_type> coroutine; /**< The running coroutine. */
+#endif
+} StreamComTask_t;
+
+/**
+ * @brief Definition of a resumable StreamCom callback.
+ *
+ * A task is called like a StreamCom_Callback, but it can return TASK_YIELD to be resumed by a later
+ * loop(). This allows long outputs or calibration sweeps without blocking the loop. Tasks are written
+ * with the STREAMCOM_TASK_* macros (protothread style), which work with each compiler.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * TaskState_e dump(Stream *stream, void *args, uint32_t nParams, StreamComTask_t *task)
+ * {
+ *     STREAMCOM_TASK_BEGIN(task);
+ *     for (task->counter = 0; task->counter < 1000; task->counter++)
+ *     {
+ *         STREAMCOM_TASK_WAIT_WRITE(task, stream, 16);
+ *         stream->println(samples[task->counter]);
+ *     }
+ *     STREAMCOM_TASK_END(task);
+ * }
+ * @endcode
+ *
+ * @param stream  A pointer to the Stream object that is used for communication.
+ * @param args    A pointer to the arguments of the service.
+ * @param nParams The number of parameters passed to the task.
+ * @param task    The state of the task.
+ * @return TASK_YIELD to be resumed, TASK_DONE if the task is finished.
+ */
+typedef TaskState_e (*StreamCom_Task)(Stream *stream, void *args, uint32_t nParams, StreamComTask_t *task);
+
+/** Starts the body of a task. */
+#define STREAMCOM_TASK_BEGIN(TASK) \
+    switch ((TASK)->line)          \
+    {                              \
+    case 0:
+
+/** Returns to loop() and continues here in the next loop(). */
+#define STREAMCOM_TASK_YIELD(TASK) \
+    do                             \
+    {                              \
+        (TASK)->line = __LINE__;   \
+        return TASK_YIELD;         \
+    case __LINE__:;                \
+    } while (0)
+
+/** Returns to loop() until the condition is true. */
+#define STREAMCOM_TASK_WAIT_UNTIL(TASK, COND) \
+    do                                        \
+    {                                         \
+        (TASK)->line = __LINE__;              \
+    case __LINE__:                            \
+        if (!(COND))                          \
+        {                                     \
+            return TASK_YIELD;                \
+        }                                     \
+    } while (0)
+
+/** Returns to loop() until the time in ms is over. */
+#define STREAMCOM_TASK_DELAY(TASK, MS)                                                  \
+    do                                                                                  \
+    {                                                                                   \
+        (TASK)->timer = millis();                                                       \
+        STREAMCOM_TASK_WAIT_UNTIL(TASK, (uint32_t)(millis() - (TASK)->timer) >= (MS)); \
+    } while (0)
+
+/** Returns to loop() until the stream can take the number of bytes without blocking. */
+#define STREAMCOM_TASK_WAIT_WRITE(TASK, STREAM, BYTES) \
+    STREAMCOM_TASK_WAIT_UNTIL(TASK, StreamCom_txReady((STREAM), (int)(BYTES)))
+
+/** Ends the body of a task. */
+#define STREAMCOM_TASK_END(TASK) \
+    }                            \
+    (TASK)->line = 0;            \
+    return TASK_DONE;
+
+#if STREAM_COM_COROUTINE_SUPPORT == true
+/**
+ * @brief Resumes the coroutine of a task if it does not wait.
+ * @param task The state of the task.
+ * @return TASK_YIELD if the coroutine is suspended, TASK_DONE if it is finished.
+ */
+inline TaskState_e StreamCom_resumeCoroutine(StreamComTask_t *task)
+{
+    StreamComCoroutine::promise_type &promise = task->coroutine.promise();
+
+    if (promise.waitStream != nullptr && !StreamCom_txReady(promise.waitStream, promise.waitBytes))
+    {
+        return TASK_YIELD;
+    }
+    if (promise.sleeping && (int32_t)(millis() - promise.wakeAt) < 0)
+    {
+        return TASK_YIELD;
+    }
+    promise.waitStream = nullptr;
+    promise.sleeping = false;
+
+    task->coroutine.resume();
+    if (task->coroutine.done())
+    {
+        task->coroutine.destroy();
+        task->coroutine = nullptr;
+        return TASK_DONE;
+    }
+    return TASK_YIELD;
+}
+
+/**
+ * @brief Defines a StreamCom_Task which runs a C++20 coroutine.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * StreamComCoroutine sweep(Stream *stream, void *args, uint32_t nParams)
+ * {
+ *     for (int i = 0; i < 100; i++)
+ *     {
+ *         co_await StreamComWaitWrite{stream, 16};
+ *         stream->println(measure(i));
+ *         co_await StreamComDelay{10};
+ *     }
+ * }
+ * STREAMCOM_COROUTINE_TASK(sweepTask, sweep)
+ * @endcode
+ *
+ * @param NAME Name of the defined task, used in the Service_t configuration.
+ * @param CORO The coroutine function.
+ */
+#define STREAMCOM_COROUTINE_TASK(NAME, CORO)                                                   \
+    TaskState_e NAME(Stream *stream, void *args, uint32_t nParams, StreamComTask_t *task) \
+    {                                                                                          \
+        if (!task->coroutine)                                                                  \
+        {                                                                                      \
+            task->coroutine = CORO(stream, args, nParams).handle;                              \
+        }                                                                                      \
+        return StreamCom_resumeCoroutine(task);                                                \
+    }
+#endif
+
+#endif /* StreamCom_Task_H_ */
@@ -0,0 +1,101 @@
+/*
+ * StreamCom_Trace.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ */
+
+#ifndef StreamCom_Trace_H_
+#define StreamCom_Trace_H_
+
+#include "Arduino.h"
+
+#ifndef STREAM_COM_TRACE_ENABLE
+#define STREAM_COM_TRACE_ENABLE false
+#endif
+
+#ifndef STREAM_COM_TRACE_BUFFER_SIZE
+#define STREAM_COM_TRACE_BUFFER_SIZE 256u
+#endif
+
+/** Size of the header of a trace record: timestamp, duration, connection, result, length. */
+#define STREAM_COM_TRACE_HEADER_SIZE 11u
+
+/**
+ * @brief Ring buffer recording the received commands.
+ *
+ * Each record holds the time of reception, the duration of the dispatch, the connection, the result and
+ * the received line. The records have a variable length, so short commands need only a few bytes. If the
+ * buffer is full, the oldest records are dropped.
+ *
+ * The dump has the following format, which is read by tools/streamcom_replay.py:
+ * @code
+ * #TRACE <records>
+ * <timestamp ms>;<duration us>;<connection>;<result>;<line>
+ * #END
+ * @endcode
+ */
+class StreamComTrace
+{
+public:
+    /**
+     * @brief constructor for the StreamComTrace class.
+     */
+    StreamComTrace(void);
+
+    /**
+     * @brief Adds a record to the trace.
+     * @param timestamp The time the command was received in ms.
+     * @param duration The duration of the dispatch in us.
+     * @param connection The index of the connection.
+     * @param result The result of the command.
+     * @param line The received line.
+     */
+    void record(uint32_t timestamp, uint32_t duration, uint8_t connection, uint8_t result, const char *line);
+
+    /**
+     * @brief Prints all records.
+     * @param out The destination of the records.
+     */
+    void dump(Print &out);
+
+    /**
+     * @brief Deletes all records.
+     */
+    void clear(void);
+
+    /**
+     * @brief Gets the quantity of records.
+     * @return The number of records.
+     */
+    uint16_t getRecordQuantity(void);
+
+private:
+    /**
+     * @brief Reads a little endian value from the ring buffer.
+     * @param pos The position in the ring buffer.
+     * @param size The number of bytes of the value.
+     * @return The read value.
+     */
+    uint32_t read(uint16_t pos, uint8_t size);
+
+    /**
+     * @brief Writes a little endian value to the ring buffer.
+     * @param value The value to write.
+     * @param size The number of bytes of the value.
+     */
+    void write(uint32_t value, uint8_t size);
+
+    /**
+     * @brief Removes the oldest record.
+     */
+    void dropOldest(void);
+
+private:
+    uint8_t m_buffer[STREAM_COM_TRACE_BUFFER_SIZE]; /**< The ring buffer. */
+    uint16_t m_tail;                                /**< Position of the oldest record. */
+    uint16_t m_used;                                /**< Number of used bytes. */
+    uint16_t m_records;                             /**< Number of records. */
+};
+
+#endif /* StreamCom_Trace_H_ */
@@ -6,23 +6,103 @@
  */
 
 #include "StreamCom.h"
+#include <float.h>
+#include <math.h>
+
+#ifdef STREAM_COM_RAM_BUDGET
+static_assert(sizeof(StreamCom) <= STREAM_COM_RAM_BUDGET, "StreamCom exceeds STREAM_COM_RAM_BUDGET");
+#endif
+
+/** Characters of the parameter types in the catalog, in the order of Types_e. */
+static const char catalogTypes[] = "bsilfdSR-";
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+static uint32_t fnv1a(uint32_t hash, uint8_t data)
+{
+	return (hash ^ data) * 16777619u;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+static uint32_t serviceHash(const Service_t &service)
+{
+	uint32_t hash = 2166136261u;
+
+	for (const char *c = service.token; *c != '\0'; c++)
+	{
+		hash = fnv1a(hash, (uint8_t)*c);
+	}
+	hash = fnv1a(hash, 0);
+	hash = fnv1a(hash, (uint8_t)service.nParams);
+	for (uint8_t i = 0; i < service.nParams && i < STREAM_COM_MAX_PARAMETER; i++)
+	{
+		hash = fnv1a(hash, (uint8_t)service.paramTypes[i]);
+	}
+	hash = fnv1a(hash, (uint8_t)service.accessLevel);
+	return fnv1a(hash, service.flags);
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+static bool sameSignature(const Service_t &a, const Service_t &b)
+{
+	if (a.nParams != b.nParams)
+	{
+		return false;
+	}
+	for (uint8_t i = 0; i < a.nParams && i < STREAM_COM_MAX_PARAMETER; i++)
+	{
+		if (a.paramTypes[i] != b.paramTypes[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
 
 // TREAM_COM_DEFAULT_LIST_ENABLE == true
 // n StreamCom* mThis;
 // n Service_t StreamCom_default_list;
 // #endif
 
+/** The instance of the current command, also used without the default list. */
+StreamCom *mThis = NULL;
+
 /*******************************************************************************
  *  FUNCTION:
  ******************************************************************************/
-StreamCom::StreamCom(void) : m_cmdDelimiter(STREAM_COM_CDM_DELIMITER),
+StreamCom::StreamCom(void) : m_serviceHash(0),
+							 m_signatureCount(0),
+							 m_servicesPeak(0),
+							 m_linePeak(0),
+							 m_jobsPeak(0),
+							 m_nextJob(0),
+							 m_connection(NULL),
+							 m_nextConnection(0),
+							 m_txReadyHook(NULL),
+							 m_cmdDelimiter(STREAM_COM_CDM_DELIMITER),
 							 m_paramDelimiter(STREAM_COM_PARAM_DELIMITER),
 							 m_stream(NULL)
+#if STREAM_COM_AUTH_ENABLE == true
+							 ,
+							 m_authKey(NULL),
+							 m_authKeyLen(0),
+							 m_authLevel(ACCESS_ADMIN)
+#endif
 {
+	memset(m_connections, 0, sizeof(m_connections));
+	for (uint8_t i = 0; i < STREAM_COM_SCHEDULER_SIZE; i++)
+	{
+		m_jobs[i] = Job_t();
+	}
 #if STREAM_COM_DEFAULT_LIST_ENABLE == true
 	for (uint16_t i = 0; i < STREAM_COM_DEFAULT_LIST_SIZE; i++)
 	{
-		m_serviceList.push_back(&StreamCom_default_list[i]);
+		appendService(StreamCom_default_list[i]);
 	}
 #endif
 }
@@ -32,387 +112,1486 @@ StreamCom::StreamCom(void) : m_cmdDelimiter(STREAM_COM_CDM_DELIMITER),
  ******************************************************************************/
 void StreamCom::loop(void)
 {
+	/*Round robin: each loop starts with the next connection, so no stream is preferred*/
+	for (uint8_t n = 0; n < STREAM_COM_MAX_CONNECTIONS; n++)
+	{
+		Connection_t &connection = m_connections[(m_nextConnection + n) % STREAM_COM_MAX_CONNECTIONS];
+		if (connection.stream != NULL)
+		{
+			pollConnection(connection);
+		}
+	}
+	m_nextConnection = (m_nextConnection + 1) % STREAM_COM_MAX_CONNECTIONS;
 
-	String str, v1, v2;
-	bool status = false;
-	bool found = false;
-	bool is_verified = false;
+	runScheduler();
+	return;
+}
 
-	if (m_stream->available() > 0)
-	{
-		str = m_stream->readString();
-		is_verified = stringVerify(&str);
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::pollConnection(Connection_t &connection)
+{
+	uint16_t budget = STREAM_COM_RX_BUDGET;
 
-		if (is_verified)
+	while (budget > 0 && connection.stream->available() > 0)
+	{
+		int c = connection.stream->read();
+		budget--;
+		if (c < 0)
 		{
-			/*Split the read String into two parts........*/
-			stringSplit(&str, &v1, m_cmdDelimiter); /*Set Split string as initialization*/
-			stringSplit(NULL, &v2, m_cmdDelimiter); /*Set NULL to use the given string for the next part*/
-
-			for (uint8_t i = 0; i < m_serviceList.size(); i++)
-			{
-				if (v1.equals(m_serviceList[i]->token))
-				{
-					if (m_serviceList[i]->nParams != 0)
-					{
-						status = executeCommand(&v2, i);
-					}
-					else
-					{
-						status = executeCommand(NULL, i);
-					}
-					found = true;
-				}
-			}
+			break;
+		}
+		connection.lastRx = millis();
 
-			if (status == false && found == true)
-			{
-				m_stream->println(F("...ERROR: CANNOT EXECUTE FUNCTION..."));
-			}
-			else if (status == false && found == false)
-			{
-				m_stream->print(F("...UNKNOWN TOKEN - "));
-				m_stream->print(str);
-				m_stream->print(F(" - Status = "));
-				m_stream->print(status);
-				m_stream->print(F(" - Found = "));
-				m_stream->print(found);
-				m_stream->println("");
-			}
-			else
+#if STREAM_COM_FRAMING_ENABLE == true
+		/*Each byte value can be part of a frame, so XON/XOFF and line endings are not used*/
+		if (connection.framing == FRAMING_COBS)
+		{
+			receiveFrame(connection, (uint8_t)c);
+			continue;
+		}
+#endif
+#if STREAM_COM_XON_XOFF_ENABLE == true
+		if (c == STREAM_COM_XOFF || c == STREAM_COM_XON)
+		{
+			connection.txPaused = (c == STREAM_COM_XOFF);
+			continue;
+		}
+#endif
+		if (c == '\n' || c == '\r')
+		{
+			if (connection.lineLen > 0 || connection.overflow)
 			{
-				/*... DO NOTHING...*/
+				processLine(connection);
 			}
 		}
+		else if (connection.lineLen < STREAM_COM_LINE_BUFFER_SIZE - 1)
+		{
+			connection.line[connection.lineLen++] = (char)c;
+		}
 		else
 		{
-			m_stream->println(F("...EMPTY STRING RECEIVED ..."));
+			connection.overflow = true;
 		}
 	}
+
+#if STREAM_COM_FRAMING_ENABLE == true
+	/*A frame is only complete with its delimiter*/
+	if (connection.framing != FRAMING_NONE)
+	{
+		return;
+	}
+#endif
+	/*Lines without line ending are processed after the stream timeout*/
+	if ((connection.lineLen > 0 || connection.overflow) &&
+		(uint32_t)(millis() - connection.lastRx) >= STREAM_COM_LINE_TIMEOUT_MS)
+	{
+		processLine(connection);
+	}
 	return;
 }
 
+#if STREAM_COM_FRAMING_ENABLE == true
 /*******************************************************************************
  *  FUNCTION:
  ******************************************************************************/
-void StreamCom::init(Stream &stream, Service_t *paramList, uint16_t size)
+void StreamCom::receiveFrame(Connection_t &connection, uint8_t c)
 {
-	m_stream = &stream;
-	mThis = this;
+	FrameStats_t &stats = connection.frameStats;
 
-	Serial.print("MTHIS: ");
-	Serial.println((uint32_t)mThis);
+	if (c != STREAM_COM_FRAME_DELIMITER)
+	{
+		int16_t data = StreamCom_cobsDecode(&connection.cobs, c);
+		if (data < 0)
+		{
+			return;
+		}
+		if (connection.lineLen < STREAM_COM_LINE_BUFFER_SIZE - 1)
+		{
+			connection.line[connection.lineLen++] = (char)data;
+			connection.crc = StreamCom_crc16Update(connection.crc, (uint8_t)data);
+		}
+		else
+		{
+			connection.overflow = true;
+		}
+		return;
+	}
 
-	for (uint16_t i = 0; i < size; i++)
+	/*The delimiter ends each frame, so a broken frame never affects the next one*/
+	if (connection.overflow)
 	{
-		m_serviceList.push_back(&paramList[i]);
+		stats.overflows++;
 	}
-	m_list_size = size;
+	else if (connection.cobs.code == 0)
+	{
+		/*Consecutive delimiters are allowed to flush the receiver*/
+	}
+	else if (connection.cobs.left != 0 || connection.lineLen < STREAM_COM_CRC16_SIZE)
+	{
+		stats.framingErrors++;
+	}
+	else if (connection.crc != 0)
+	{
+		stats.crcErrors++;
+	}
+	else
+	{
+		stats.frames++;
+		connection.lineLen -= STREAM_COM_CRC16_SIZE;
+		processLine(connection);
+	}
+	resetFrame(connection);
 }
 
 /*******************************************************************************
  *  FUNCTION:
  ******************************************************************************/
-bool StreamCom::executeCommand(String *paramStr, uint8_t paramListIdx)
+void StreamCom::resetFrame(Connection_t &connection)
 {
-	bool status = false;
+	connection.lineLen = 0;
+	connection.overflow = false;
+	connection.cobs.code = 0;
+	connection.cobs.left = 0;
+	connection.crc = STREAM_COM_CRC16_INIT;
+}
+#endif
 
-	if (paramStr != NULL)
-	{
-		status = splitParameter(paramStr, paramListIdx);
-		if (status == true)
-		{
-			convertParameter(paramListIdx);
-		}
-	}
-	else
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::beginOutput(Connection_t &connection)
+{
+	m_connection = &connection;
+	m_stream = connection.stream;
+	mThis = this;
+
+#if STREAM_COM_FRAMING_ENABLE == true
+	if (connection.framing != FRAMING_NONE)
 	{
-		status = !paramsAvailable(paramListIdx);
+		m_framer.begin(connection.stream);
+		m_stream = &m_framer;
 	}
-
-	executeCallback(paramListIdx);
-	return status;
+#endif
 }
 
 /*******************************************************************************
  *  FUNCTION:
  ******************************************************************************/
-void StreamCom::stringSplit(String *strToSplit, String *strToStore, const char *delimiter)
+void StreamCom::endOutput(Connection_t &connection)
 {
-	char *avPtr = NULL;
-	if (strToStore != NULL)
+#if STREAM_COM_FRAMING_ENABLE == true
+	if (m_stream == &m_framer)
 	{
-		if (strToSplit != NULL)
-		{
-			avPtr = strtok((char *)strToSplit->c_str(), delimiter);
-		}
-		else
-		{
-			avPtr = strtok(NULL, delimiter);
-		}
-
-		if (avPtr != NULL)
-		{
-			*strToStore = String(avPtr);
-		}
+		/*Output outside of a command is not framed*/
+		m_framer.flush();
+		m_stream = connection.stream;
 	}
-
-	return;
+#endif
 }
 
 /*******************************************************************************
  *  FUNCTION:
  ******************************************************************************/
-void StreamCom::executeCallback(uint8_t paramListIdx)
+void StreamCom::processLine(Connection_t &connection)
 {
-	Service_t *entry = m_serviceList[paramListIdx];
+	char *str;
+	Result_e result;
 
-	if (entry->callback != nullptr)
+	/*Responses are only sent to the stream the command came from*/
+	beginOutput(connection);
+
+	if (connection.lineLen > m_linePeak)
 	{
-		entry->callback(m_stream, entry->params, entry->nParams);
+		m_linePeak = connection.lineLen;
 	}
+	connection.line[connection.lineLen] = '\0';
+	str = stringVerify(connection.line);
+
+#if STREAM_COM_TRACE_ENABLE == true
+	/*The parser splits the line in place, so the trace needs a copy*/
+	char traceLine[STREAM_COM_LINE_BUFFER_SIZE];
+	uint32_t start = micros();
+	strcpy(traceLine, (str != NULL && !connection.overflow) ? str : "");
+#endif
+
+	if (connection.overflow)
+	{
+		result = RESULT_LINE_TOO_LONG;
+	}
+	else if (str != NULL)
+	{
+		result = dispatch(str);
+	}
+	else
+	{
+		result = RESULT_EMPTY;
+	}
+	printResult(result, str);
+
+#if STREAM_COM_TRACE_ENABLE == true
+	m_trace.record(millis(), micros() - start, &connection - m_connections, result, traceLine);
+#endif
+	endOutput(connection);
+
+	connection.lineLen = 0;
+	connection.overflow = false;
 	return;
 }
 
 /*******************************************************************************
  *  FUNCTION:
  ******************************************************************************/
-bool StreamCom::splitParameter(String *paramStr, uint8_t paramListIdx)
+Result_e StreamCom::dispatch(char *str)
 {
-	bool firstCall = true;
-	bool ret = false;
+	Result_e result = RESULT_UNKNOWN_TOKEN;
 
-	if ((m_serviceList[paramListIdx]->nParams <= STREAM_COM_MAX_PARAMETER) &&
-		(m_serviceList[paramListIdx]->nParams > 0))
+	/*Split the read line into token and parameter part........*/
+	char *v2 = stringSplit(str, m_cmdDelimiter);
+
+#if STREAM_COM_AUTH_ENABLE == true && STREAM_COM_AUTH_SESSION_TIMEOUT_MS > 0
+	/*An idle session expires, so a later client of the same stream (e.g. TelnetStream) does not inherit it*/
+	if (m_connection->accessLevel > ACCESS_PUBLIC &&
+		(uint32_t)(millis() - m_connection->lastCommand) >= STREAM_COM_AUTH_SESSION_TIMEOUT_MS)
 	{
-		for (uint32_t i = 0; (i < m_serviceList[paramListIdx]->nParams); i++)
-		{
-			m_params[i] = "";
+		logout();
+	}
+	m_connection->lastCommand = millis();
+#endif
 
-			if (firstCall == true)
+	for (uint16_t i = 0; i < m_serviceList.size(); i++)
+	{
+		if (strcmp(str, m_serviceList[i]->token) == 0)
+		{
+#if STREAM_COM_AUTH_ENABLE == true
+			/*Access check before anything of the command is touched*/
+			if (m_serviceList[i]->accessLevel > m_connection->accessLevel)
 			{
-				stringSplit(paramStr, &m_params[i], m_paramDelimiter);
-				firstCall = false;
+				result = RESULT_ACCESS_DENIED;
+				continue;
+			}
+#endif
+			if (m_serviceList[i]->nParams != 0)
+			{
+				result = executeCommand(v2 != NULL ? v2 : (char *)"", i);
 			}
 			else
 			{
-				stringSplit(NULL, &m_params[i], m_paramDelimiter);
+				result = executeCommand(NULL, i);
 			}
 		}
-		ret = true;
-	}
-	else if (m_serviceList[paramListIdx]->nParams == 0)
-	{
-		/*Nothing needs to be done. Skip this code...*/
-		ret = false;
 	}
-	else
-	{
-		m_stream->println(F("...NUMBER OF PARAMETER OUT OF BOUNDS..."));
-		ret = false;
-	}
-	return ret;
+	return result;
 }
 
 /*******************************************************************************
  *  FUNCTION:
  ******************************************************************************/
-template <typename T>
-T StreamCom::convert(Types_e type, uint8_t paramIdx)
+void StreamCom::printResult(Result_e result, const char *token)
 {
-	switch (type)
+	switch (result)
 	{
-	case I8:
-	case I16:
-	case I32:
-	case I64:
-		return static_cast<T>(m_params[paramIdx].toInt());
-	case F:
-	case D:
-		return static_cast<T>(m_params[paramIdx].toDouble());
-	case STR:
-	case RAW:
+	case RESULT_ACCESS_DENIED:
+		m_stream->println(F("...ERROR: ACCESS DENIED..."));
+		break;
+	case RESULT_EXEC_FAILED:
+		m_stream->println(F("...ERROR: CANNOT EXECUTE FUNCTION..."));
+		break;
+	case RESULT_UNKNOWN_TOKEN:
+		m_stream->print(F("...UNKNOWN TOKEN - "));
+		m_stream->print(token);
+		m_stream->print(F(" - Status = 0 - Found = 0"));
+		m_stream->println("");
+		break;
+	case RESULT_PARAM_COUNT:
+		m_stream->println(F("...ERROR: TOO FEW PARAMETERS..."));
+		break;
+	case RESULT_PARAM_FORMAT:
+		printParamError(F(" IS NOT A NUMBER..."));
+		break;
+	case RESULT_PARAM_RANGE:
+		printParamError(F(" OUT OF RANGE..."));
+		break;
+	case RESULT_PARAM_NOT_ALLOWED:
+		printParamError(F(" NOT ALLOWED..."));
+		break;
+	case RESULT_PARAM_TOO_LONG:
+		printParamError(F(" TOO LONG..."));
+		break;
+	case RESULT_PARAM_PATTERN:
+		printParamError(F(" DOES NOT MATCH PATTERN..."));
+		break;
+	case RESULT_QUEUE_FULL:
+		m_stream->println(F("...ERROR: SCHEDULER QUEUE FULL..."));
+		break;
+	case RESULT_BUSY:
+		m_stream->println(F("...ERROR: SERVICE BUSY..."));
+		break;
+	case RESULT_LINE_TOO_LONG:
+		m_stream->println(F("...ERROR: LINE TOO LONG..."));
+		break;
+	case RESULT_EMPTY:
+		m_stream->println(F("...EMPTY STRING RECEIVED ..."));
+		break;
+	case RESULT_OK:
 	default:
-		return static_cast<T>(0); // Return converted 0 because String don't need to be converted.
+		/*... DO NOTHING...*/
+		break;
 	}
 }
 
 /*******************************************************************************
  *  FUNCTION:
  ******************************************************************************/
-void StreamCom::convertParameter(uint8_t paramListIdx)
+void StreamCom::printParamError(const __FlashStringHelper *reason)
 {
-	Service_t *entry = (Service_t *)m_serviceList[paramListIdx];
-	if (paramListIdx < m_serviceList.size())
-	{
-		for (uint8_t i = 0; i < entry->nParams; i++)
-		{
-			uint8_t index = i;
-			switch (entry->paramTypes[i])
-			{
-			case I8:
-			{
-				int8_t *i8 = static_cast<int8_t *>(entry->params[index]);
-				*i8 = convert<int8_t>(I8, i);
-				break;
-			}
-			case I16:
-			{
-				int16_t *i16 = static_cast<int16_t *>(entry->params[index]);
-				*i16 = convert<int16_t>(I16, index);
-				break;
-			}
-			case I32:
-			{
-				int32_t *i32 = static_cast<int32_t *>(entry->params[index]);
-				*i32 = convert<int32_t>(I32, index);
-				break;
-			}
-			case I64:
-			{
-				int64_t *i64 = static_cast<int64_t *>(entry->params[index]);
-				*i64 = convert<int64_t>(I64, index);
-				break;
-			}
-			case F:
-			{
-				float *f = static_cast<float *>(entry->params[index]);
-				*f = convert<float>(F, index);
-				break;
-			}
-			case D:
-			{
-				double *d = static_cast<double *>(entry->params[index]);
-				*d = convert<double>(D, index);
-				break;
-			}
-			case STR: /* String is a special case. No convertion needed.*/
-			{
-				String *str = static_cast<String *>(entry->params[index]);
-				*str = String(m_params[index]);
-				break;
-			}
-			case RAW:
-			case NONE:
-			default:
-			{
-
-				break;
-			}
-			}
-		}
-	}
+	m_stream->print(F("...ERROR: PARAMETER "));
+	m_stream->print(m_errorParam);
+	m_stream->println(reason);
 }
 
 /*******************************************************************************
  *  FUNCTION:
  ******************************************************************************/
-bool StreamCom::paramsAvailable(uint8_t paramListIdx)
+void StreamCom::init(Stream &stream, Service_t *paramList, uint16_t size)
 {
-	return m_serviceList[paramListIdx]->nParams > 0 ? true : false;
+	m_stream = &stream;
+	mThis = this;
+	attach(stream);
+
+	for (uint16_t i = 0; i < size; i++)
+	{
+		if (appendService(paramList[i]) == false)
+		{
+			m_stream->println(F("...ERROR: SERVICE LIST FULL..."));
+			break;
+		}
+	}
+	m_list_size = size;
 }
 
 /*******************************************************************************
  *  FUNCTION:
  ******************************************************************************/
-bool StreamCom::stringVerify(String *readString)
+bool StreamCom::attach(Stream &stream)
 {
-	bool ret = false;
-	bool cr_lf_eos;
-	if (readString != NULL)
+	Connection_t *slot = NULL;
+	for (uint8_t i = 0; i < STREAM_COM_MAX_CONNECTIONS; i++)
 	{
-		readString->trim();
-		cr_lf_eos = readString->endsWith("\r\n");
-		if (cr_lf_eos)
+		if (m_connections[i].stream == &stream)
 		{
-			readString->remove(readString->length() - 3, 2);
+			return true;
 		}
+		if (slot == NULL && m_connections[i].stream == NULL)
+		{
+			slot = &m_connections[i];
+		}
+	}
+
+	if (slot != NULL)
+	{
+		memset(slot, 0, sizeof(Connection_t));
+		slot->stream = &stream;
 
-		if (readString->length() > 0)
+		/*Streams without TX buffer information report 0, they are not paced*/
+		slot->txCapacity = stream.availableForWrite();
+		slot->txPacing = (slot->txCapacity > 0);
+		if (m_stream == NULL)
 		{
-			ret = true;
+			m_stream = &stream;
 		}
 	}
-	return ret;
+	return slot != NULL;
 }
 
-uint16_t StreamCom::getServiceQuantity(void)
-{
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::detach(Stream &stream)
+{
+	for (uint8_t i = 0; i < STREAM_COM_MAX_CONNECTIONS; i++)
+	{
+		if (m_connections[i].stream == &stream)
+		{
+			memset(&m_connections[i], 0, sizeof(Connection_t));
+		}
+	}
+	for (uint8_t i = 0; i < STREAM_COM_SCHEDULER_SIZE; i++)
+	{
+		if (m_jobs[i].connection != NULL && m_jobs[i].connection->stream == NULL)
+		{
+			freeJob(m_jobs[i]);
+		}
+	}
+	if (m_connection != NULL && m_connection->stream == NULL)
+	{
+		m_connection = NULL;
+	}
+	if (m_stream == &stream)
+	{
+		m_stream = NULL;
+	}
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::setTxPacing(Stream &stream, bool pacing)
+{
+	Connection_t *connection = findConnection(&stream);
+	if (connection != NULL)
+	{
+		connection->txPacing = pacing;
+	}
+}
+
+#if STREAM_COM_FRAMING_ENABLE == true
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::setFraming(Stream &stream, Framing_e framing)
+{
+	Connection_t *connection = findConnection(&stream);
+	if (connection != NULL)
+	{
+		connection->framing = framing;
+		resetFrame(*connection);
+	}
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+bool StreamCom::getFrameStats(Stream &stream, FrameStats_t &stats)
+{
+	Connection_t *connection = findConnection(&stream);
+	if (connection != NULL)
+	{
+		stats = connection->frameStats;
+	}
+	return connection != NULL;
+}
+#endif
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::setTxReadyHook(StreamCom_TxReadyHook hook)
+{
+	m_txReadyHook = hook;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+bool StreamCom::txReady(Stream *stream, int bytes)
+{
+#if STREAM_COM_FRAMING_ENABLE == true
+	/*Framed output is paced by the stream of the connection*/
+	if (stream == &m_framer)
+	{
+		stream = m_framer.getStream();
+	}
+#endif
+	Connection_t *connection = findConnection(stream);
+	bool ready = true;
+
+	if (m_txReadyHook != NULL && m_txReadyHook(stream) == false)
+	{
+		ready = false;
+	}
+	else if (connection != NULL && connection->txPaused)
+	{
+		ready = false;
+	}
+	else if (connection != NULL && connection->txPacing)
+	{
+		int available = stream->availableForWrite();
+		if (available > connection->txCapacity)
+		{
+			connection->txCapacity = available;
+		}
+
+		/*More than the whole TX buffer can never be free, so wait for an empty buffer*/
+		ready = available >= ((bytes < connection->txCapacity) ? bytes : connection->txCapacity);
+	}
+	return ready;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+Connection_t *StreamCom::findConnection(Stream *stream)
+{
+	for (uint8_t i = 0; i < STREAM_COM_MAX_CONNECTIONS; i++)
+	{
+		if (stream != NULL && m_connections[i].stream == stream)
+		{
+			return &m_connections[i];
+		}
+	}
+	return NULL;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+uint8_t StreamCom::getConnectionQuantity(void)
+{
+	uint8_t quantity = 0;
+	for (uint8_t i = 0; i < STREAM_COM_MAX_CONNECTIONS; i++)
+	{
+		if (m_connections[i].stream != NULL)
+		{
+			quantity++;
+		}
+	}
+	return quantity;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+Result_e StreamCom::executeCommand(char *paramStr, uint16_t paramListIdx)
+{
+	Result_e result = RESULT_OK;
+	Service_t *entry = m_serviceList[paramListIdx];
+	bool deferred = (entry->flags & SERVICE_DEFERRED) || entry->interval > 0 || entry->task != NULL;
+	Job_t *job = NULL;
+
+	if (paramStr != NULL)
+	{
+		/*All parameters are checked before the first one is written*/
+		result = splitParameter(paramStr, paramListIdx);
+		if (result == RESULT_OK)
+		{
+			result = validateParameter(paramListIdx);
+		}
+	}
+	else if (paramsAvailable(paramListIdx))
+	{
+		result = RESULT_EXEC_FAILED;
+	}
+
+	/*The job is found before the parameters are written, so a command rejected by the scheduler changes nothing*/
+	if (result == RESULT_OK && deferred)
+	{
+		result = findJob(entry, &job);
+	}
+	if (result == RESULT_OK && paramStr != NULL && convertParameter(paramListIdx) == false)
+	{
+		result = RESULT_EXEC_FAILED;
+	}
+
+	/*The callback is only called for a successful parsed command*/
+	if (result == RESULT_OK)
+	{
+		if (deferred)
+		{
+			scheduleCallback(entry, job);
+		}
+		else
+		{
+			executeCallback(paramListIdx);
+		}
+	}
+	return result;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+char *StreamCom::stringSplit(char *strToSplit, const char *delimiter)
+{
+	char *next = NULL;
+	if (strToSplit != NULL)
+	{
+		char *idx = strstr(strToSplit, delimiter);
+		if (idx != NULL)
+		{
+			*idx = '\0';
+			next = idx + strlen(delimiter);
+		}
+	}
+	return next;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::executeCallback(uint16_t paramListIdx)
+{
+	Service_t *entry = m_serviceList[paramListIdx];
+
+	if (entry->callback != nullptr)
+	{
+		entry->callback(m_stream, entry->params, entry->nParams);
+	}
+	return;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+Result_e StreamCom::findJob(Service_t *entry, Job_t **job)
+{
+	Job_t *slot = NULL;
+	/*A task without parameters has no shared state, so each connection runs its own job*/
+	bool perConnection = (entry->task != NULL && entry->nParams == 0);
+
+	*job = NULL;
+	for (uint8_t i = 0; i < STREAM_COM_SCHEDULER_SIZE && *job == NULL; i++)
+	{
+		if (m_jobs[i].service == entry && (perConnection == false || m_jobs[i].connection == m_connection))
+		{
+			*job = &m_jobs[i];
+		}
+		else if (slot == NULL && m_jobs[i].service == NULL)
+		{
+			slot = &m_jobs[i];
+		}
+	}
+
+	if (*job != NULL && (*job)->running)
+	{
+		/*The running task still uses the variables of the service*/
+		return RESULT_BUSY;
+	}
+	if (*job == NULL)
+	{
+		if (slot == NULL)
+		{
+			return RESULT_QUEUE_FULL;
+		}
+		*job = slot;
+	}
+	return RESULT_OK;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::scheduleCallback(Service_t *entry, Job_t *job)
+{
+	uint32_t now = millis();
+
+	if (job->service == NULL)
+	{
+		job->service = entry;
+		job->pending = false;
+
+		uint8_t used = 0;
+		for (uint8_t i = 0; i < STREAM_COM_SCHEDULER_SIZE; i++)
+		{
+			used += (m_jobs[i].service != NULL) ? 1 : 0;
+		}
+		if (used > m_jobsPeak)
+		{
+			m_jobsPeak = used;
+		}
+	}
+
+	/*A queued job is only moved, the variables already hold the latest parameters*/
+	job->connection = m_connection;
+	if (entry->flags & SERVICE_DEBOUNCE)
+	{
+		job->due = now + entry->interval;
+	}
+	else if (job->pending == false)
+	{
+		ServiceState_t *state = serviceState(entry);
+		bool elapsed = (state == NULL) || (state->called == false) || (uint32_t)(now - state->lastRun) >= entry->interval;
+		job->due = elapsed ? now : state->lastRun + entry->interval;
+	}
+	job->pending = true;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::runScheduler(void)
+{
+	uint32_t start = micros();
+	uint8_t first = m_nextJob;
+	uint8_t next = first;
+	bool budget = true;
+
+	for (uint8_t n = 0; n < STREAM_COM_SCHEDULER_SIZE; n++)
+	{
+		Job_t &job = m_jobs[(first + n) % STREAM_COM_SCHEDULER_SIZE];
+		uint32_t now = millis();
+
+		if (job.service == NULL)
+		{
+			continue;
+		}
+
+		if (budget && (job.running || (job.pending && (int32_t)(now - job.due) >= 0)))
+		{
+			runJob(job);
+			next = (first + n + 1) % STREAM_COM_SCHEDULER_SIZE;
+
+			/*The rate limit is kept in the service, so the slot is free once the job is done*/
+			if (job.pending == false && job.running == false)
+			{
+				freeJob(job);
+			}
+
+			/*At least one job runs per loop, the others only within the budget*/
+			budget = (uint32_t)(micros() - start) < STREAM_COM_SCHEDULER_BUDGET_US;
+		}
+	}
+
+	/*The next loop starts after the last job which ran*/
+	m_nextJob = next;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::runJob(Job_t &job)
+{
+	Service_t *entry = job.service;
+	ServiceState_t *state = NULL;
+
+	beginOutput(*job.connection);
+
+	if (job.running == false)
+	{
+		job.pending = false;
+		job.task = StreamComTask_t();
+		job.running = (entry->task != NULL);
+		state = serviceState(entry);
+		if (state != NULL)
+		{
+			state->lastRun = millis();
+			state->called = true;
+		}
+		if (entry->callback != nullptr)
+		{
+			entry->callback(m_stream, entry->params, entry->nParams);
+		}
+	}
+
+	if (job.running && entry->task(m_stream, entry->params, entry->nParams, &job.task) == TASK_DONE)
+	{
+		/*The rate limit of a task starts when it is finished*/
+		job.running = false;
+		state = serviceState(entry);
+		if (state != NULL)
+		{
+			state->lastRun = millis();
+		}
+	}
+	endOutput(*job.connection);
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::freeJob(Job_t &job)
+{
+#if STREAM_COM_COROUTINE_SUPPORT == true
+	if (job.task.coroutine)
+	{
+		job.task.coroutine.destroy();
+	}
+#endif
+	job = Job_t();
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+Result_e StreamCom::splitParameter(char *paramStr, uint16_t paramListIdx)
+{
+	char *next = paramStr;
+	Result_e ret = RESULT_EXEC_FAILED;
+
+	if ((m_serviceList[paramListIdx]->nParams <= STREAM_COM_MAX_PARAMETER) &&
+		(m_serviceList[paramListIdx]->nParams > 0))
+	{
+		ret = RESULT_OK;
+		for (uint32_t i = 0; (i < m_serviceList[paramListIdx]->nParams); i++)
+		{
+			if (next == NULL)
+			{
+				m_errorParam = i + 1;
+				ret = RESULT_PARAM_COUNT;
+				break;
+			}
+			m_params[i] = next;
+			next = stringSplit(next, m_paramDelimiter);
+		}
+	}
+	else if (m_serviceList[paramListIdx]->nParams == 0)
+	{
+		/*Nothing needs to be done. Skip this code...*/
+		ret = RESULT_EXEC_FAILED;
+	}
+	else
+	{
+		m_stream->println(F("...NUMBER OF PARAMETER OUT OF BOUNDS..."));
+		ret = RESULT_EXEC_FAILED;
+	}
+	return ret;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+static bool patternMatch(const char *text, const char *pattern)
+{
+	const char *starPattern = NULL;
+	const char *starText = NULL;
+
+	while (*text != '\0')
+	{
+		char p = *pattern;
+		bool match = false;
+
+		if (p == '*')
+		{
+			/*Remember the position to go back if the rest does not match*/
+			starPattern = ++pattern;
+			starText = text;
+			continue;
+		}
+		else if (p == '\\' && pattern[1] != '\0')
+		{
+			match = (pattern[1] == *text);
+			if (match)
+			{
+				pattern++;
+			}
+		}
+		else if (p != '\0')
+		{
+			match = (p == '?') ||
+					(p == '#' && isdigit((unsigned char)*text)) ||
+					(p == '@' && isalpha((unsigned char)*text)) ||
+					(p == *text);
+		}
+
+		if (match)
+		{
+			pattern++;
+			text++;
+		}
+		else if (starPattern != NULL)
+		{
+			pattern = starPattern;
+			text = ++starText;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	while (*pattern == '*')
+	{
+		pattern++;
+	}
+	return *pattern == '\0';
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+static int64_t parseInteger(const char *text, char **end, bool *overflow)
+{
+	const char *c = text;
+	const char *digits;
+	bool negative = false;
+	uint64_t value = 0;
+	uint64_t limit;
+
+	/*Like strtoll(text, end, 10), which is not available on each target (e.g. avr-libc)*/
+	*overflow = false;
+	while (isspace((unsigned char)*c))
+	{
+		c++;
+	}
+	if (*c == '+' || *c == '-')
+	{
+		negative = (*c == '-');
+		c++;
+	}
+	limit = negative ? (uint64_t)INT64_MAX + 1u : (uint64_t)INT64_MAX;
+
+	for (digits = c; isdigit((unsigned char)*c); c++)
+	{
+		uint8_t digit = *c - '0';
+		if (value > (limit - digit) / 10u)
+		{
+			*overflow = true;
+		}
+		else
+		{
+			value = value * 10u + digit;
+		}
+	}
+	*end = (char *)((c == digits) ? text : c);
+
+	if (*overflow)
+	{
+		value = limit;
+	}
+	if (negative)
+	{
+		return (value == 0) ? 0 : -(int64_t)(value - 1u) - 1;
+	}
+	return (int64_t)value;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+static bool oneOfMatch(const char *text, double value, bool numeric, const char *values)
+{
+	size_t len = strlen(text);
+
+	while (values != NULL && *values != '\0')
+	{
+		const char *end = strchr(values, '|');
+		size_t entryLen = (end != NULL) ? (size_t)(end - values) : strlen(values);
+
+		if (numeric)
+		{
+			if (strtod(values, NULL) == value)
+			{
+				return true;
+			}
+		}
+		else if (entryLen == len && strncmp(values, text, len) == 0)
+		{
+			return true;
+		}
+		values = (end != NULL) ? end + 1 : NULL;
+	}
+	return false;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+Result_e StreamCom::validateParameter(uint16_t paramListIdx)
+{
+	Service_t *entry = m_serviceList[paramListIdx];
+	Result_e ret = RESULT_OK;
+
+	for (uint8_t i = 0; ret == RESULT_OK && i < entry->nParams && i < STREAM_COM_MAX_PARAMETER; i++)
+	{
+		const char *text = m_params[i];
+		Types_e type = entry->paramTypes[i];
+		bool numeric = (type <= D);
+		double value = 0;
+		char *end = (char *)text;
+
+		/*Syntax and range of the data type*/
+		if (type <= I64)
+		{
+			bool overflow;
+			int64_t l = parseInteger(text, &end, &overflow);
+			m_values[i].l = l;
+			value = (double)l;
+			if ((type == I8 && (l < INT8_MIN || l > INT8_MAX)) ||
+				(type == I16 && (l < INT16_MIN || l > INT16_MAX)) ||
+				(type == I32 && (l < INT32_MIN || l > INT32_MAX)) ||
+				overflow)
+			{
+				ret = RESULT_PARAM_RANGE;
+			}
+		}
+		else if (numeric)
+		{
+			value = strtod(text, &end);
+			m_values[i].d = value;
+
+			/*NaN and infinity would pass each min/max check*/
+			if (isnan(value))
+			{
+				ret = RESULT_PARAM_FORMAT;
+			}
+			else if (isinf(value) || (type == F && (value > FLT_MAX || value < -FLT_MAX)))
+			{
+				ret = RESULT_PARAM_RANGE;
+			}
+		}
+		if (numeric)
+		{
+			while (isspace((unsigned char)*end))
+			{
+				end++;
+			}
+			if (end == text || *end != '\0')
+			{
+				ret = RESULT_PARAM_FORMAT;
+			}
+		}
+
+#if STREAM_COM_STATIC_ALLOCATION == true
+		/*The text has to fit into the char buffer of the parameter*/
+		if (type == STR && strlen(text) >= STREAM_COM_STRING_SIZE)
+		{
+			ret = RESULT_PARAM_TOO_LONG;
+		}
+#endif
+
+		/*Declared constraints of the parameter*/
+		if (ret == RESULT_OK && entry->constraints != NULL)
+		{
+			const Constraint_t &c = entry->constraints[i];
+
+			if (((c.checks & CHECK_MIN) && numeric && value < c.min) ||
+				((c.checks & CHECK_MAX) && numeric && value > c.max))
+			{
+				ret = RESULT_PARAM_RANGE;
+			}
+			else if ((c.checks & CHECK_ONE_OF) && !oneOfMatch(text, value, numeric, c.oneOf))
+			{
+				ret = RESULT_PARAM_NOT_ALLOWED;
+			}
+			else if ((c.checks & CHECK_MAX_LEN) && strlen(text) > c.maxLength)
+			{
+				ret = RESULT_PARAM_TOO_LONG;
+			}
+			else if ((c.checks & CHECK_PATTERN) && c.pattern != NULL && !patternMatch(text, c.pattern))
+			{
+				ret = RESULT_PARAM_PATTERN;
+			}
+		}
+
+		if (ret != RESULT_OK)
+		{
+			m_errorParam = i + 1;
+		}
+	}
+	return ret;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+template <typename T>
+T StreamCom::convert(Types_e type, uint8_t paramIdx)
+{
+	switch (type)
+	{
+	case I8:
+	case I16:
+	case I32:
+	case I64:
+		return static_cast<T>(m_values[paramIdx].l);
+	case F:
+	case D:
+		return static_cast<T>(m_values[paramIdx].d);
+	case STR:
+	case RAW:
+	default:
+		return static_cast<T>(0); // Return converted 0 because String don't need to be converted.
+	}
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+bool StreamCom::convertParameter(uint16_t paramListIdx)
+{
+	bool ret = false;
+	if (paramListIdx < m_serviceList.size())
+	{
+		Service_t *entry = m_serviceList[paramListIdx];
+		ret = true;
+
+		/*Check all pointers first, so an incomplete entry does not write anything*/
+		for (uint8_t i = 0; i < entry->nParams && i < STREAM_COM_MAX_PARAMETER; i++)
+		{
+			if (entry->params[i] == NULL && entry->paramTypes[i] != RAW && entry->paramTypes[i] != NONE)
+			{
+				ret = false;
+			}
+		}
+
+		for (uint8_t i = 0; ret && i < entry->nParams && i < STREAM_COM_MAX_PARAMETER; i++)
+		{
+			uint8_t index = i;
+			switch (entry->paramTypes[i])
+			{
+			case I8:
+			{
+				int8_t *i8 = static_cast<int8_t *>(entry->params[index]);
+				*i8 = convert<int8_t>(I8, i);
+				break;
+			}
+			case I16:
+			{
+				int16_t *i16 = static_cast<int16_t *>(entry->params[index]);
+				*i16 = convert<int16_t>(I16, index);
+				break;
+			}
+			case I32:
+			{
+				int32_t *i32 = static_cast<int32_t *>(entry->params[index]);
+				*i32 = convert<int32_t>(I32, index);
+				break;
+			}
+			case I64:
+			{
+				int64_t *i64 = static_cast<int64_t *>(entry->params[index]);
+				*i64 = convert<int64_t>(I64, index);
+				break;
+			}
+			case F:
+			{
+				float *f = static_cast<float *>(entry->params[index]);
+				*f = convert<float>(F, index);
+				break;
+			}
+			case D:
+			{
+				double *d = static_cast<double *>(entry->params[index]);
+				*d = convert<double>(D, index);
+				break;
+			}
+			case STR: /* String is a special case. No convertion needed.*/
+			{
+#if STREAM_COM_STATIC_ALLOCATION == true
+				/*The length was checked by validateParameter()*/
+				strcpy(static_cast<char *>(entry->params[index]), m_params[index]);
+#else
+				String *str = static_cast<String *>(entry->params[index]);
+				*str = String(m_params[index]);
+#endif
+				break;
+			}
+			case RAW:
+			case NONE:
+			default:
+			{
+
+				break;
+			}
+			}
+		}
+	}
+	return ret;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+bool StreamCom::paramsAvailable(uint16_t paramListIdx)
+{
+	return m_serviceList[paramListIdx]->nParams > 0 ? true : false;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+char *StreamCom::stringVerify(char *readString)
+{
+	char *ret = NULL;
+	if (readString != NULL)
+	{
+		/*Trim leading and trailing whitespaces in place*/
+		size_t len = strlen(readString);
+		while (len > 0 && isspace((unsigned char)readString[len - 1]))
+		{
+			readString[--len] = '\0';
+		}
+		while (isspace((unsigned char)*readString))
+		{
+			readString++;
+		}
+
+		if (*readString != '\0')
+		{
+			ret = readString;
+		}
+	}
+	return ret;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::getMemoryReport(MemoryReport_t &report)
+{
+	report.instanceSize = sizeof(StreamCom);
+	report.connectionSize = sizeof(Connection_t);
+	report.services = m_serviceList.size();
+	report.servicesCapacity = m_serviceList.capacity();
+	report.servicesPeak = m_servicesPeak;
+	report.linePeak = m_linePeak;
+	report.jobsPeak = m_jobsPeak;
+	report.staticAllocation = (STREAM_COM_STATIC_ALLOCATION == true);
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::printMemoryReport(Print &out)
+{
+	MemoryReport_t report;
+	getMemoryReport(report);
+
+	out.print(F("MEM: instance "));
+	out.print(report.instanceSize);
+	out.print(F(" B, connection "));
+	out.print(report.connectionSize);
+	out.print(F(" B x "));
+	out.print(STREAM_COM_MAX_CONNECTIONS);
+	out.println(report.staticAllocation ? F(", static") : F(", heap"));
+	out.print(F("MEM: services "));
+	out.print(report.services);
+	out.print('/');
+	out.print(report.servicesCapacity);
+	out.print(F(" peak "));
+	out.println(report.servicesPeak);
+	out.print(F("MEM: line peak "));
+	out.print(report.linePeak);
+	out.print('/');
+	out.println(STREAM_COM_LINE_BUFFER_SIZE - 1);
+	out.print(F("MEM: jobs peak "));
+	out.print(report.jobsPeak);
+	out.print('/');
+	out.println(STREAM_COM_SCHEDULER_SIZE);
+}
+
+uint16_t StreamCom::getServiceQuantity(void)
+{
 	return m_serviceList.size();
 }
 
-/**
- * @brief Gibt eine Hilfe mit allen konfigurierten Parametern aus.
- */
-void StreamCom::printHelp()
+/**
+ * @brief Gibt eine Hilfe mit allen konfigurierten Parametern aus.
+ */
+void StreamCom::printHelp()
+{
+	for (uint16_t part = 0; part <= m_serviceList.size(); part++)
+	{
+		printHelpPart(*m_stream, part);
+	}
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+TaskState_e StreamCom::printHelpPaced(Stream &stream, StreamComTask_t *task)
+{
+	/*task->counter is the cursor: 0 is the header, n the n-th service*/
+	while (task->counter <= m_serviceList.size())
+	{
+		StreamComPrintCounter size;
+		printHelpPart(size, task->counter);
+		if (txReady(&stream, size.count) == false)
+		{
+			return TASK_YIELD;
+		}
+		printHelpPart(stream, task->counter);
+		task->counter++;
+	}
+	return TASK_DONE;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::printHelpPart(Print &out, uint16_t part)
 {
-	m_stream->println("The following commands are available:");
-	m_stream->println("");
-	m_stream->println("Service: 0 ---------");
-	for (uint16_t i = 0; i < m_serviceList.size(); i++)
+	if (part == 0)
+	{
+		out.println("The following commands are available:");
+		out.println("");
+		out.println("Service: 0 ---------");
+		return;
+	}
+
+	const Service_t &paramList = *m_serviceList[part - 1];
+	out.print("Command: ");
+	out.println(paramList.token);
+
+	if (paramList.nParams > 0)
 	{
-		const Service_t &paramList = *m_serviceList[i];
-		m_stream->print("Command: ");
-		m_stream->println(paramList.token);
+		out.println("Parameters:");
 
-		if (paramList.nParams > 0)
+		for (uint8_t j = 0; j < paramList.nParams && j < STREAM_COM_MAX_PARAMETER; j++)
 		{
-			m_stream->println("Parameters:");
+			out.print("  - Parameter ");
+			out.print(j + 1);
+			out.print(": ");
+
+			switch (paramList.paramTypes[j])
+			{
+			case I8:
+				out.print("Signed 8-bit integer");
+				break;
+			case I16:
+				out.print("Signed 16-bit integer");
+				break;
+			case I32:
+				out.print("Signed 32-bit integer");
+				break;
+			case I64:
+				out.print("Signed 64-bit integer");
+				break;
+			case F:
+				out.print("Floating-point number");
+				break;
+			case D:
+				out.print("Double-precision floating-point number");
+				break;
+			case STR:
+				out.print("String");
+				break;
+			case NONE:
+				out.print("No Parameter");
+				break;
+			default:
+				out.print("Unknown type");
+				break;
+			}
 
-			for (uint8_t j = 0; j < paramList.nParams; j++)
+			if (paramList.constraints != NULL)
 			{
-				m_stream->print("  - Parameter ");
-				m_stream->print(j + 1);
-				m_stream->print(": ");
+				printConstraint(out, paramList.constraints[j]);
+			}
+			out.println("");
+		}
+	}
+	else
+	{
+		out.println("No parameters.");
+	}
+
+	out.print("Service: ");
+	out.print(part);
+	out.println(" ---------");
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+TaskState_e StreamCom::printCatalogPaced(Stream &stream, StreamComTask_t *task)
+{
+	/*task->counter is the cursor: header, signature table, services, end*/
+	while (task->counter <= m_serviceList.size() + 2u)
+	{
+		StreamComPrintCounter size;
+		printCatalogPart(size, task->counter);
+		if (txReady(&stream, size.count) == false)
+		{
+			return TASK_YIELD;
+		}
+		printCatalogPart(stream, task->counter);
+		task->counter++;
+	}
+	return TASK_DONE;
+}
 
-				switch (paramList.paramTypes[j])
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::printCatalogPart(Print &out, uint16_t part)
+{
+	if (part == 0)
+	{
+		out.print(F("#CATALOG "));
+		out.print(m_serviceList.size());
+		out.print(';');
+		out.println(m_serviceHash, HEX);
+	}
+	else if (part == 1)
+	{
+		/*Each signature is only printed at its first use*/
+		out.print('T');
+		for (uint16_t i = 0; i < m_serviceList.size(); i++)
+		{
+			if (m_serviceStates[i].signatureFirst)
+			{
+				out.print(';');
+				for (uint8_t j = 0; j < m_serviceList[i]->nParams && j < STREAM_COM_MAX_PARAMETER; j++)
 				{
-				case I8:
-					m_stream->println("Signed 8-bit integer");
-					break;
-				case I16:
-					m_stream->println("Signed 16-bit integer");
-					break;
-				case I32:
-					m_stream->println("Signed 32-bit integer");
-					break;
-				case I64:
-					m_stream->println("Signed 64-bit integer");
-					break;
-				case F:
-					m_stream->println("Floating-point number");
-					break;
-				case D:
-					m_stream->println("Double-precision floating-point number");
-					break;
-				case STR:
-					m_stream->println("String");
-					break;
-				case NONE:
-					m_stream->println("No Parameter");
-					break;
-				default:
-					m_stream->println("Unknown type");
-					break;
+					uint8_t type = m_serviceList[i]->paramTypes[j];
+					out.print(catalogTypes[(type <= NONE) ? type : (uint8_t)NONE]);
 				}
 			}
 		}
-		else
+		out.println("");
+	}
+	else if (part <= m_serviceList.size() + 1u)
+	{
+		const Service_t &service = *m_serviceList[part - 2];
+		const char *previous = (part > 2) ? m_serviceList[part - 3]->token : "";
+		uint8_t prefix = 0;
+
+		while (prefix < 35 && service.token[prefix] != '\0' && service.token[prefix] == previous[prefix])
 		{
-			m_stream->println("No parameters.");
+			prefix++;
 		}
+		out.print((char)((prefix < 10) ? '0' + prefix : 'A' + prefix - 10));
+		out.print(&service.token[prefix]);
+		out.print(';');
+		out.print(m_serviceStates[part - 2].signature);
+		out.print(';');
+		out.print((uint8_t)service.accessLevel);
+		out.print(';');
+		out.println(service.flags);
+	}
+	else
+	{
+		out.println(F("#END"));
+	}
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+uint32_t StreamCom::getServiceHash(void)
+{
+	return m_serviceHash;
+}
 
-		m_stream->print("Service: ");
-		m_stream->print((uint16_t)i + 1);
-		m_stream->println(" ---------");
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::printConstraint(Print &out, const Constraint_t &constraint)
+{
+	if (constraint.checks & CHECK_MIN)
+	{
+		out.print(" | min: ");
+		out.print(constraint.min);
+	}
+	if (constraint.checks & CHECK_MAX)
+	{
+		out.print(" | max: ");
+		out.print(constraint.max);
+	}
+	if ((constraint.checks & CHECK_ONE_OF) && constraint.oneOf != NULL)
+	{
+		out.print(" | one of: ");
+		out.print(constraint.oneOf);
+	}
+	if (constraint.checks & CHECK_MAX_LEN)
+	{
+		out.print(" | max. length: ");
+		out.print(constraint.maxLength);
+	}
+	if ((constraint.checks & CHECK_PATTERN) && constraint.pattern != NULL)
+	{
+		out.print(" | pattern: ");
+		out.print(constraint.pattern);
 	}
 }
 
 void StreamCom::addService(Service_t &service)
 {
-	if (serviceExists(service.token) == -1)
+	if (serviceExists(service.token) == -1 && appendService(service) == false && m_stream != NULL)
 	{
-		m_serviceList.push_back(&service);
+		m_stream->println(F("...ERROR: SERVICE LIST FULL..."));
 	}
 }
 
@@ -420,7 +1599,10 @@ void StreamCom::deleteService(uint16_t service_entry)
 {
 	if (service_entry < m_serviceList.size())
 	{
+		m_serviceHash -= serviceHash(*m_serviceList[service_entry]);
+		removeSignature(service_entry);
 		m_serviceList.erase(m_serviceList.begin() + service_entry);
+		m_serviceStates.erase(m_serviceStates.begin() + service_entry);
 	}
 }
 
@@ -433,6 +1615,121 @@ void StreamCom::deleteService(const char *service_token)
 	}
 }
 
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+bool StreamCom::appendService(Service_t &service)
+{
+#if STREAM_COM_STATIC_ALLOCATION == true
+	if (m_serviceList.push_back(&service) == false)
+	{
+		return false;
+	}
+#else
+	m_serviceList.push_back(&service);
+#endif
+	/*Both lists have the same capacity*/
+	m_serviceStates.push_back(ServiceState_t());
+	m_serviceHash += serviceHash(service);
+
+	/*The signature table lists each signature at its first use*/
+	ServiceState_t &state = m_serviceStates[m_serviceStates.size() - 1];
+	state.signature = m_signatureCount;
+	state.signatureFirst = true;
+	for (uint16_t i = 0; i + 1u < m_serviceList.size(); i++)
+	{
+		if (m_serviceStates[i].signatureFirst && sameSignature(*m_serviceList[i], service))
+		{
+			state.signature = m_serviceStates[i].signature;
+			state.signatureFirst = false;
+			break;
+		}
+	}
+	if (state.signatureFirst)
+	{
+		m_signatureCount++;
+	}
+	if (m_serviceList.size() > m_servicesPeak)
+	{
+		m_servicesPeak = m_serviceList.size();
+	}
+	return true;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::removeSignature(uint16_t service_entry)
+{
+	const ServiceState_t &removed = m_serviceStates[service_entry];
+	uint16_t signature = removed.signature;
+	uint16_t between = 0;
+	int32_t next = -1;
+
+	if (removed.signatureFirst == false)
+	{
+		return;
+	}
+
+	/*The next service with the signature takes over, the signatures first used in between move forward*/
+	for (uint16_t i = service_entry + 1; i < m_serviceList.size() && next < 0; i++)
+	{
+		if (m_serviceStates[i].signature == signature)
+		{
+			next = i;
+		}
+		else if (m_serviceStates[i].signatureFirst)
+		{
+			between++;
+		}
+	}
+
+	for (uint16_t i = 0; i < m_serviceList.size(); i++)
+	{
+		ServiceState_t &state = m_serviceStates[i];
+		if (i == service_entry)
+		{
+			continue;
+		}
+		if (next < 0)
+		{
+			state.signature -= (state.signature > signature) ? 1 : 0;
+		}
+		else if (state.signature == signature)
+		{
+			state.signature = signature + between;
+		}
+		else if (state.signature > signature && state.signature <= signature + between)
+		{
+			state.signature--;
+		}
+	}
+
+	if (next < 0)
+	{
+		m_signatureCount--;
+	}
+	else
+	{
+		m_serviceStates[next].signatureFirst = true;
+	}
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+ServiceState_t *StreamCom::serviceState(const Service_t *service)
+{
+	for (uint16_t i = 0; i < m_serviceList.size(); i++)
+	{
+		if (m_serviceList[i] == service)
+		{
+			return &m_serviceStates[i];
+		}
+	}
+	return NULL;
+}
+
 int16_t StreamCom::serviceExists(const char *serviceToken)
 {
 	bool exists = false;
@@ -446,4 +1743,186 @@ int16_t StreamCom::serviceExists(const char *serviceToken)
 		}
 	}
 	return service_num;
-}
\ No newline at end of file
+}
+#if STREAM_COM_AUTH_ENABLE == true
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::setAuthKey(const uint8_t *key, uint8_t keyLen, AccessLevel_e level)
+{
+	m_authKey = key;
+	m_authKeyLen = keyLen;
+	m_authLevel = level;
+
+	/*A new key invalidates all sessions*/
+	for (uint8_t i = 0; i < STREAM_COM_MAX_CONNECTIONS; i++)
+	{
+		m_connections[i].accessLevel = ACCESS_PUBLIC;
+		m_connections[i].challengeValid = false;
+	}
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::requestChallenge(void)
+{
+	StreamCom_Sha256_t ctx;
+	uint8_t digest[STREAM_COM_SHA256_DIGEST_SIZE];
+	uint32_t entropy[3] = {(uint32_t)micros(), (uint32_t)millis(), (uint32_t)random(0x7FFFFFFF)};
+
+	if (m_connection == NULL)
+	{
+		return;
+	}
+	if (m_authKey == NULL || m_authKeyLen == 0)
+	{
+		m_stream->println(F("...ERROR: NO AUTH KEY CONFIGURED..."));
+		return;
+	}
+
+	/*Chain the last challenge with the current time to get an unique nonce*/
+	StreamCom_sha256Init(&ctx);
+	StreamCom_sha256Update(&ctx, m_connection->challenge, STREAM_COM_AUTH_CHALLENGE_SIZE);
+	StreamCom_sha256Update(&ctx, (const uint8_t *)entropy, sizeof(entropy));
+	StreamCom_sha256Final(&ctx, digest);
+
+	memcpy(m_connection->challenge, digest, STREAM_COM_AUTH_CHALLENGE_SIZE);
+	m_connection->challengeValid = true;
+
+	m_stream->print(F("CHALLENGE: "));
+	for (uint8_t i = 0; i < STREAM_COM_AUTH_CHALLENGE_SIZE; i++)
+	{
+		if (m_connection->challenge[i] < 0x10)
+		{
+			m_stream->print('0');
+		}
+		m_stream->print(m_connection->challenge[i], HEX);
+	}
+	m_stream->println("");
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+bool StreamCom::authenticate(const char *response)
+{
+	uint8_t expected[STREAM_COM_SHA256_DIGEST_SIZE];
+	uint8_t received[STREAM_COM_SHA256_DIGEST_SIZE];
+	bool valid = (response != NULL) && (strlen(response) == 2 * STREAM_COM_SHA256_DIGEST_SIZE);
+
+	if (m_connection == NULL || authLocked() || m_connection->challengeValid == false || m_authKey == NULL)
+	{
+		return false;
+	}
+	m_connection->challengeValid = false; /*A challenge can only be used once*/
+
+	for (uint8_t i = 0; valid && i < 2 * STREAM_COM_SHA256_DIGEST_SIZE; i++)
+	{
+		char c = response[i];
+		uint8_t nibble;
+		if (c >= '0' && c <= '9')
+		{
+			nibble = c - '0';
+		}
+		else if (c >= 'a' && c <= 'f')
+		{
+			nibble = c - 'a' + 10;
+		}
+		else if (c >= 'A' && c <= 'F')
+		{
+			nibble = c - 'A' + 10;
+		}
+		else
+		{
+			valid = false;
+			break;
+		}
+		received[i / 2] = (i % 2 == 0) ? (nibble << 4) : (received[i / 2] | nibble);
+	}
+
+	StreamCom_hmacSha256(m_authKey, m_authKeyLen, m_connection->challenge, STREAM_COM_AUTH_CHALLENGE_SIZE, expected);
+	valid = valid && StreamCom_constTimeEquals(expected, received, STREAM_COM_SHA256_DIGEST_SIZE);
+
+	if (valid)
+	{
+		m_connection->accessLevel = m_authLevel;
+		m_connection->authFailures = 0;
+	}
+	else
+	{
+		m_connection->accessLevel = ACCESS_PUBLIC;
+		if (++m_connection->authFailures >= STREAM_COM_AUTH_MAX_FAILURES)
+		{
+			m_connection->lockoutStart = millis();
+		}
+	}
+	return valid;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+bool StreamCom::authLocked(void)
+{
+	bool locked = false;
+	if (m_connection->authFailures >= STREAM_COM_AUTH_MAX_FAILURES)
+	{
+		if ((uint32_t)(millis() - m_connection->lockoutStart) < STREAM_COM_AUTH_LOCKOUT_MS)
+		{
+			locked = true;
+		}
+		else
+		{
+			m_connection->authFailures = 0;
+		}
+	}
+	return locked;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::logout(void)
+{
+	if (m_connection != NULL)
+	{
+		m_connection->accessLevel = ACCESS_PUBLIC;
+		m_connection->challengeValid = false;
+	}
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+AccessLevel_e StreamCom::getAccessLevel(void)
+{
+	return (m_connection != NULL) ? m_connection->accessLevel : ACCESS_PUBLIC;
+}
+#endif
+
+#if STREAM_COM_TRACE_ENABLE == true
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::dumpTrace(Print &out)
+{
+	m_trace.dump(out);
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom::clearTrace(void)
+{
+	m_trace.clear();
+}
+#endif
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+bool StreamCom_txReady(Stream *stream, int bytes)
+{
+	return (mThis != NULL) ? mThis->txReady(stream, bytes) : true;
+}
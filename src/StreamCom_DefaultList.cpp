@@ -12,8 +12,6 @@
 
 #if STREAM_COM_DEFAULT_LIST_ENABLE == true
 
-StreamCom *mThis;
-
 void StreamCom_Reset(Stream *stream, void *args, uint32_t nParams)
 {
     stream->print("STREAM_COM: Reset ESP \r\n");
@@ -27,16 +25,14 @@ void StreamCom_Reset(Stream *stream, void *args, uint32_t nParams)
 #endif
 }
 
-void StreamCom_Help(Stream *stream, void *args, uint32_t nParams)
+TaskState_e StreamCom_Help(Stream *stream, void *args, uint32_t nParams, StreamComTask_t *task)
 {
     if (mThis != NULL)
     {
-        mThis->printHelp();
-    }
-    else
-    {
-        stream->println("HELP: Could Not Print Help");
+        return mThis->printHelpPaced(*stream, task);
     }
+    stream->println("HELP: Could Not Print Help");
+    return TASK_DONE;
 }
 
 void StreamCom_Size(Stream *stream, void *args, uint32_t nParams)
@@ -55,12 +51,137 @@ void StreamCom_Size(Stream *stream, void *args, uint32_t nParams)
     }
 }
 
+TaskState_e StreamCom_Catalog(Stream *stream, void *args, uint32_t nParams, StreamComTask_t *task)
+{
+    if (mThis != NULL)
+    {
+        return mThis->printCatalogPaced(*stream, task);
+    }
+    stream->println("CATALOG: Could Not Print Catalog");
+    return TASK_DONE;
+}
+
+void StreamCom_Hash(Stream *stream, void *args, uint32_t nParams)
+{
+    if (mThis != NULL)
+    {
+        stream->print("HASH: ");
+        stream->println(mThis->getServiceHash(), HEX);
+    }
+    else
+    {
+        stream->println("HASH: Could Not Get Hash");
+    }
+}
+
+void StreamCom_Mem(Stream *stream, void *args, uint32_t nParams)
+{
+    if (mThis != NULL)
+    {
+        mThis->printMemoryReport(*stream);
+    }
+    else
+    {
+        stream->println("MEM: Could Not Print Report");
+    }
+}
+
+#if STREAM_COM_AUTH_ENABLE == true
+#if STREAM_COM_STATIC_ALLOCATION == true
+char StreamCom_auth_response[STREAM_COM_STRING_SIZE];
+#else
+String StreamCom_auth_response;
+#endif
+const Constraint_t StreamCom_auth_constraints[] = {STREAMCOM_MAX_LEN(2 * STREAM_COM_SHA256_DIGEST_SIZE)};
+
+void StreamCom_Auth(Stream *stream, void *args, uint32_t nParams)
+{
+    if (mThis != NULL)
+    {
+        mThis->requestChallenge();
+    }
+    else
+    {
+        stream->println("AUTH: Could Not Create Challenge");
+    }
+}
+
+void StreamCom_Login(Stream *stream, void *args, uint32_t nParams)
+{
+#if STREAM_COM_STATIC_ALLOCATION == true
+    char *response = STREAMCOM_GET_PTR(char, args, 0);
+    const char *text = response;
+#else
+    String &response = STREAMCOM_GET_VALUE(String, args, 0);
+    const char *text = response.c_str();
+#endif
+
+    if (mThis != NULL && mThis->authenticate(text))
+    {
+        stream->println("LOGIN: OK");
+    }
+    else
+    {
+        stream->println("LOGIN: Failed");
+    }
+#if STREAM_COM_STATIC_ALLOCATION == true
+    response[0] = '\0';
+#else
+    response = "";
+#endif
+}
+
+void StreamCom_Logout(Stream *stream, void *args, uint32_t nParams)
+{
+    if (mThis != NULL)
+    {
+        mThis->logout();
+    }
+    stream->println("LOGOUT: OK");
+}
+#endif
+
+#if STREAM_COM_TRACE_ENABLE == true
+void StreamCom_Trace(Stream *stream, void *args, uint32_t nParams)
+{
+    if (mThis != NULL)
+    {
+        mThis->dumpTrace(*stream);
+    }
+    else
+    {
+        stream->println("TRACE: Could Not Print Trace");
+    }
+}
+
+void StreamCom_TraceClear(Stream *stream, void *args, uint32_t nParams)
+{
+    if (mThis != NULL)
+    {
+        mThis->clearTrace();
+    }
+    stream->println("TRACE_CLR: OK");
+}
+#endif
+
 Service_t StreamCom_default_list[STREAM_COM_DEFAULT_LIST_SIZE] =
     {
-        /*Nr.  | TOKEN          |   POINTER_TO_PARAMS         |    TYPE_OF_PARAMS    | SIZE  | CALLBACK       |*/
-        /* 1*/ {"RESET", {NULL, NULL, NULL, NULL}, {NONE, NONE, NONE, NONE}, 0, StreamCom_Reset},
-        /* 2*/ {"HELP", {NULL, NULL, NULL, NULL}, {NONE, NONE, NONE, NONE}, 0, StreamCom_Help},
-        /* 2*/ {"SIZE", {NULL, NULL, NULL, NULL}, {NONE, NONE, NONE, NONE}, 0, StreamCom_Size},
+        /*Nr.  | TOKEN          |   POINTER_TO_PARAMS         |    TYPE_OF_PARAMS    | SIZE  | CALLBACK       | ACCESS       | CONSTRAINTS | FLAGS | INTERVAL | TASK |*/
+        /* 1*/ {"RESET", {NULL, NULL, NULL, NULL}, {NONE, NONE, NONE, NONE}, 0, StreamCom_Reset, ACCESS_ADMIN, NULL, 0, 0, NULL},
+        /* 2*/ {"HELP", {NULL, NULL, NULL, NULL}, {NONE, NONE, NONE, NONE}, 0, NULL, ACCESS_PUBLIC, NULL, 0, 0, StreamCom_Help},
+        /* 2*/ {"SIZE", {NULL, NULL, NULL, NULL}, {NONE, NONE, NONE, NONE}, 0, StreamCom_Size, ACCESS_PUBLIC, NULL, 0, 0, NULL},
+        /* 4*/ {"CATALOG", {NULL, NULL, NULL, NULL}, {NONE, NONE, NONE, NONE}, 0, NULL, ACCESS_PUBLIC, NULL, 0, 0, StreamCom_Catalog},
+        /* 5*/ {"HASH", {NULL, NULL, NULL, NULL}, {NONE, NONE, NONE, NONE}, 0, StreamCom_Hash, ACCESS_PUBLIC, NULL, 0, 0, NULL},
+        /* 6*/ {"MEM", {NULL, NULL, NULL, NULL}, {NONE, NONE, NONE, NONE}, 0, StreamCom_Mem, ACCESS_PUBLIC, NULL, 0, 0, NULL},
+#if STREAM_COM_AUTH_ENABLE == true
+        /* 7*/ {"AUTH", {NULL, NULL, NULL, NULL}, {NONE, NONE, NONE, NONE}, 0, StreamCom_Auth, ACCESS_PUBLIC, NULL, 0, 0, NULL},
+        /* 8*/ {"LOGIN", {&StreamCom_auth_response, NULL, NULL, NULL}, {STR, NONE, NONE, NONE}, 1, StreamCom_Login, ACCESS_PUBLIC, StreamCom_auth_constraints, 0, 0, NULL},
+        /* 9*/ {"LOGOUT", {NULL, NULL, NULL, NULL}, {NONE, NONE, NONE, NONE}, 0, StreamCom_Logout, ACCESS_PUBLIC, NULL, 0, 0, NULL},
+#endif
+#if STREAM_COM_TRACE_ENABLE == true
+        /*10*/ {"TRACE", {NULL, NULL, NULL, NULL}, {NONE, NONE, NONE, NONE}, 0, StreamCom_Trace, ACCESS_ADMIN, NULL, 0, 0, NULL},
+        /*11*/ {"TRACE_CLR", {NULL, NULL, NULL, NULL}, {NONE, NONE, NONE, NONE}, 0, StreamCom_TraceClear, ACCESS_ADMIN, NULL, 0, 0, NULL},
+#endif
 
 };
 
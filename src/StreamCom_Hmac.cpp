@@ -0,0 +1,201 @@
+/*
+ * StreamCom_Hmac.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ */
+
+#include "StreamCom_Hmac.h"
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static const uint32_t sha256_k[64] PROGMEM = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+static void sha256Transform(StreamCom_Sha256_t *ctx, const uint8_t *block)
+{
+	uint32_t w[64];
+	uint32_t a, b, c, d, e, f, g, h;
+
+	for (uint8_t i = 0; i < 16; i++)
+	{
+		w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+			   ((uint32_t)block[i * 4 + 2] << 8) | ((uint32_t)block[i * 4 + 3]);
+	}
+	for (uint8_t i = 16; i < 64; i++)
+	{
+		uint32_t s0 = ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+		uint32_t s1 = ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	a = ctx->state[0];
+	b = ctx->state[1];
+	c = ctx->state[2];
+	d = ctx->state[3];
+	e = ctx->state[4];
+	f = ctx->state[5];
+	g = ctx->state[6];
+	h = ctx->state[7];
+
+	for (uint8_t i = 0; i < 64; i++)
+	{
+		uint32_t s1 = ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25);
+		uint32_t ch = (e & f) ^ (~e & g);
+		uint32_t t1 = h + s1 + ch + pgm_read_dword(&sha256_k[i]) + w[i];
+		uint32_t s0 = ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22);
+		uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+		uint32_t t2 = s0 + maj;
+
+		h = g;
+		g = f;
+		f = e;
+		e = d + t1;
+		d = c;
+		c = b;
+		b = a;
+		a = t1 + t2;
+	}
+
+	ctx->state[0] += a;
+	ctx->state[1] += b;
+	ctx->state[2] += c;
+	ctx->state[3] += d;
+	ctx->state[4] += e;
+	ctx->state[5] += f;
+	ctx->state[6] += g;
+	ctx->state[7] += h;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom_sha256Init(StreamCom_Sha256_t *ctx)
+{
+	ctx->state[0] = 0x6a09e667;
+	ctx->state[1] = 0xbb67ae85;
+	ctx->state[2] = 0x3c6ef372;
+	ctx->state[3] = 0xa54ff53a;
+	ctx->state[4] = 0x510e527f;
+	ctx->state[5] = 0x9b05688c;
+	ctx->state[6] = 0x1f83d9ab;
+	ctx->state[7] = 0x5be0cd19;
+	ctx->length = 0;
+	ctx->blockLen = 0;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom_sha256Update(StreamCom_Sha256_t *ctx, const uint8_t *data, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+	{
+		ctx->block[ctx->blockLen++] = data[i];
+		if (ctx->blockLen == STREAM_COM_SHA256_BLOCK_SIZE)
+		{
+			sha256Transform(ctx, ctx->block);
+			ctx->blockLen = 0;
+		}
+	}
+	ctx->length += len;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom_sha256Final(StreamCom_Sha256_t *ctx, uint8_t *digest)
+{
+	uint64_t bits = ctx->length * 8;
+
+	ctx->block[ctx->blockLen++] = 0x80;
+	if (ctx->blockLen > STREAM_COM_SHA256_BLOCK_SIZE - 8)
+	{
+		while (ctx->blockLen < STREAM_COM_SHA256_BLOCK_SIZE)
+		{
+			ctx->block[ctx->blockLen++] = 0;
+		}
+		sha256Transform(ctx, ctx->block);
+		ctx->blockLen = 0;
+	}
+	while (ctx->blockLen < STREAM_COM_SHA256_BLOCK_SIZE - 8)
+	{
+		ctx->block[ctx->blockLen++] = 0;
+	}
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		ctx->block[STREAM_COM_SHA256_BLOCK_SIZE - 1 - i] = (uint8_t)(bits >> (i * 8));
+	}
+	sha256Transform(ctx, ctx->block);
+
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		digest[i * 4] = (uint8_t)(ctx->state[i] >> 24);
+		digest[i * 4 + 1] = (uint8_t)(ctx->state[i] >> 16);
+		digest[i * 4 + 2] = (uint8_t)(ctx->state[i] >> 8);
+		digest[i * 4 + 3] = (uint8_t)(ctx->state[i]);
+	}
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamCom_hmacSha256(const uint8_t *key, size_t keyLen, const uint8_t *msg, size_t msgLen, uint8_t *mac)
+{
+	StreamCom_Sha256_t ctx;
+	uint8_t pad[STREAM_COM_SHA256_BLOCK_SIZE];
+	uint8_t keyHash[STREAM_COM_SHA256_DIGEST_SIZE];
+
+	/*Keys longer than one block are hashed first (RFC 2104)*/
+	if (keyLen > STREAM_COM_SHA256_BLOCK_SIZE)
+	{
+		StreamCom_sha256Init(&ctx);
+		StreamCom_sha256Update(&ctx, key, keyLen);
+		StreamCom_sha256Final(&ctx, keyHash);
+		key = keyHash;
+		keyLen = STREAM_COM_SHA256_DIGEST_SIZE;
+	}
+
+	/*Inner hash: H((K ^ ipad) || msg)*/
+	for (uint8_t i = 0; i < STREAM_COM_SHA256_BLOCK_SIZE; i++)
+	{
+		pad[i] = (i < keyLen ? key[i] : 0) ^ 0x36;
+	}
+	StreamCom_sha256Init(&ctx);
+	StreamCom_sha256Update(&ctx, pad, sizeof(pad));
+	StreamCom_sha256Update(&ctx, msg, msgLen);
+	StreamCom_sha256Final(&ctx, mac);
+
+	/*Outer hash: H((K ^ opad) || inner)*/
+	for (uint8_t i = 0; i < STREAM_COM_SHA256_BLOCK_SIZE; i++)
+	{
+		pad[i] = (i < keyLen ? key[i] : 0) ^ 0x5c;
+	}
+	StreamCom_sha256Init(&ctx);
+	StreamCom_sha256Update(&ctx, pad, sizeof(pad));
+	StreamCom_sha256Update(&ctx, mac, STREAM_COM_SHA256_DIGEST_SIZE);
+	StreamCom_sha256Final(&ctx, mac);
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+bool StreamCom_constTimeEquals(const uint8_t *a, const uint8_t *b, size_t len)
+{
+	volatile uint8_t diff = 0;
+	for (size_t i = 0; i < len; i++)
+	{
+		diff = diff | (a[i] ^ b[i]);
+	}
+	return diff == 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * StreamCom_Trace.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ */
+
+#include "StreamCom_Trace.h"
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+StreamComTrace::StreamComTrace(void) : m_tail(0),
+									   m_used(0),
+									   m_records(0)
+{
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamComTrace::record(uint32_t timestamp, uint32_t duration, uint8_t connection, uint8_t result, const char *line)
+{
+	size_t len = strlen(line);
+
+	/*Truncate the line if the record would not fit into the whole buffer*/
+	if (len > 255u)
+	{
+		len = 255u;
+	}
+	if (len > STREAM_COM_TRACE_BUFFER_SIZE - STREAM_COM_TRACE_HEADER_SIZE)
+	{
+		len = STREAM_COM_TRACE_BUFFER_SIZE - STREAM_COM_TRACE_HEADER_SIZE;
+	}
+
+	while (STREAM_COM_TRACE_BUFFER_SIZE - m_used < STREAM_COM_TRACE_HEADER_SIZE + len)
+	{
+		dropOldest();
+	}
+
+	write(timestamp, 4);
+	write(duration, 4);
+	write(connection, 1);
+	write(result, 1);
+	write(len, 1);
+	for (size_t i = 0; i < len; i++)
+	{
+		write((uint8_t)line[i], 1);
+	}
+	m_records++;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamComTrace::dump(Print &out)
+{
+	uint16_t pos = m_tail;
+
+	out.print(F("#TRACE "));
+	out.println(m_records);
+
+	for (uint16_t r = 0; r < m_records; r++)
+	{
+		uint8_t len = read(pos + 10, 1);
+
+		out.print(read(pos, 4));
+		out.print(';');
+		out.print(read(pos + 4, 4));
+		out.print(';');
+		out.print(read(pos + 8, 1));
+		out.print(';');
+		out.print(read(pos + 9, 1));
+		out.print(';');
+		for (uint8_t i = 0; i < len; i++)
+		{
+			out.print((char)read(pos + STREAM_COM_TRACE_HEADER_SIZE + i, 1));
+		}
+		out.println("");
+
+		pos = (pos + STREAM_COM_TRACE_HEADER_SIZE + len) % STREAM_COM_TRACE_BUFFER_SIZE;
+	}
+	out.println(F("#END"));
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamComTrace::clear(void)
+{
+	m_tail = 0;
+	m_used = 0;
+	m_records = 0;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+uint16_t StreamComTrace::getRecordQuantity(void)
+{
+	return m_records;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+uint32_t StreamComTrace::read(uint16_t pos, uint8_t size)
+{
+	uint32_t value = 0;
+	for (uint8_t i = 0; i < size; i++)
+	{
+		value |= (uint32_t)m_buffer[(pos + i) % STREAM_COM_TRACE_BUFFER_SIZE] << (8 * i);
+	}
+	return value;
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamComTrace::write(uint32_t value, uint8_t size)
+{
+	for (uint8_t i = 0; i < size; i++)
+	{
+		m_buffer[(m_tail + m_used) % STREAM_COM_TRACE_BUFFER_SIZE] = (uint8_t)(value >> (8 * i));
+		m_used++;
+	}
+}
+
+/*******************************************************************************
+ *  FUNCTION:
+ ******************************************************************************/
+void StreamComTrace::dropOldest(void)
+{
+	if (m_records > 0)
+	{
+		uint16_t size = STREAM_COM_TRACE_HEADER_SIZE + read(m_tail + 10, 1);
+		m_tail = (m_tail + size) % STREAM_COM_TRACE_BUFFER_SIZE;
+		m_used -= size;
+		m_records--;
+	}
+}
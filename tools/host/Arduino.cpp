@@ -0,0 +1,18 @@
+/*
+ * Arduino.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ */
+
+#include "Arduino.h"
+#include <chrono>
+
+unsigned long hostMicros = 0;
+bool hostRealTime = false;
+
+unsigned long hostClockMicros(void)
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
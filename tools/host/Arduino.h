@@ -0,0 +1,171 @@
+/*
+ * Arduino.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ *
+ * Host stand-in of the Arduino API used by StreamCom. It is only used to build the fuzz harness and
+ * the host tests in tools/host, it is not part of the library.
+ */
+
+#ifndef Arduino_H_
+#define Arduino_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <string>
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+#define DEC 10
+#define HEX 16
+
+/** Time of the host, can be moved forward by the tests. */
+extern unsigned long hostMicros;
+
+/** The time follows the clock of the PC instead of hostMicros, so real durations can be measured. */
+extern bool hostRealTime;
+
+/** Time of the clock of the PC since the first call. */
+unsigned long hostClockMicros(void);
+
+inline unsigned long micros(void) { return hostRealTime ? hostClockMicros() : hostMicros; }
+inline unsigned long millis(void) { return micros() / 1000u; }
+inline long random(long max) { return rand() % max; }
+
+class String
+{
+public:
+    String(void) {}
+    String(const char *text) : m_text(text != NULL ? text : "") {}
+    String &operator=(const char *text)
+    {
+        m_text = (text != NULL) ? text : "";
+        return *this;
+    }
+    const char *c_str(void) const { return m_text.c_str(); }
+    unsigned int length(void) const { return m_text.size(); }
+
+private:
+    std::string m_text;
+};
+
+class Print
+{
+public:
+    virtual ~Print(void) {}
+    virtual size_t write(uint8_t data) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size--)
+        {
+            n += write(*buffer++);
+        }
+        return n;
+    }
+    virtual int availableForWrite(void) { return 0; }
+    virtual void flush(void) {}
+
+    size_t write(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+    size_t print(const char *text) { return write(text); }
+    size_t print(const __FlashStringHelper *text) { return write((const char *)text); }
+    size_t print(const String &text) { return write(text.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(int value, int base = DEC) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = DEC)
+    {
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), (base == HEX) ? "%lX" : "%ld", value);
+        return write(buffer);
+    }
+    size_t print(unsigned long value, int base = DEC)
+    {
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), (base == HEX) ? "%lX" : "%lu", value);
+        return write(buffer);
+    }
+    size_t print(double value, int digits = 2)
+    {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+        return write(buffer);
+    }
+    template <typename T>
+    size_t println(T value) { return print(value) + write("\r\n"); }
+    template <typename T>
+    size_t println(T value, int format) { return print(value, format) + write("\r\n"); }
+    size_t println(void) { return write("\r\n"); }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available(void) = 0;
+    virtual int read(void) = 0;
+    virtual int peek(void) = 0;
+};
+
+/**
+ * Stream with fixed buffers, so it does not allocate memory itself. Received bytes are fed by the test,
+ * the output is collected in tx (truncated to its size, txTotal counts all bytes).
+ */
+class HostStream : public Stream
+{
+public:
+    HostStream(void) : rxLen(0), rxPos(0), txLen(0), txTotal(0), room(0) {}
+
+    int available(void) { return rxLen - rxPos; }
+    int read(void) { return (rxPos < rxLen) ? rx[rxPos++] : -1; }
+    int peek(void) { return (rxPos < rxLen) ? rx[rxPos] : -1; }
+    int availableForWrite(void) { return room; }
+    size_t write(uint8_t data)
+    {
+        if (txLen < sizeof(tx))
+        {
+            tx[txLen++] = data;
+        }
+        txTotal++;
+        return 1;
+    }
+
+    /** Appends received bytes, returns the number of bytes which fit into the buffer. */
+    size_t feed(const uint8_t *data, size_t len)
+    {
+        if (rxPos == rxLen)
+        {
+            rxPos = rxLen = 0;
+        }
+        size_t n = 0;
+        while (n < len && rxLen < (int)sizeof(rx))
+        {
+            rx[rxLen++] = data[n++];
+        }
+        return n;
+    }
+    size_t feed(const char *text) { return feed((const uint8_t *)text, strlen(text)); }
+    void clearTx(void) { txLen = 0; }
+
+    uint8_t rx[1024];
+    int rxLen;
+    int rxPos;
+    char tx[4096];
+    size_t txLen;
+    size_t txTotal;
+    int room; /**< Reported free TX space, 0 disables the pacing. */
+};
+
+#endif /* Arduino_H_ */
@@ -0,0 +1,136 @@
+/*
+ * alloc_test.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ *
+ * Host test of the static allocation profile (STREAM_COM_STATIC_ALLOCATION). operator new is replaced
+ * by a counter, the test fails if init() or any command allocates memory. See tools/host/Makefile.
+ */
+
+#include "StreamCom.h"
+#include <new>
+
+#if STREAM_COM_STATIC_ALLOCATION != true
+#error "alloc_test.cpp has to be built with STREAM_COM_STATIC_ALLOCATION=true"
+#endif
+
+static unsigned long allocations = 0;
+static bool counting = false;
+
+void *operator new(size_t size)
+{
+    if (counting)
+    {
+        allocations++;
+    }
+    void *ptr = malloc(size != 0 ? size : 1);
+    if (ptr == NULL)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete[](void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { free(ptr); }
+
+static int32_t level;
+static float gain;
+static char name[STREAM_COM_STRING_SIZE];
+static char mode[STREAM_COM_STRING_SIZE];
+static int16_t speed;
+
+static const Constraint_t levelConstraints[] = {STREAMCOM_RANGE(0, 100), STREAMCOM_RANGE(0.0, 2.0)};
+static const Constraint_t modeConstraints[] = {STREAMCOM_ONE_OF("ON|OFF|AUTO")};
+
+static void printLevel(Stream *stream, void *args, uint32_t nParams)
+{
+    stream->print(F("LEVEL: "));
+    stream->println((long)level);
+}
+
+static TaskState_e countTask(Stream *stream, void *args, uint32_t nParams, StreamComTask_t *task)
+{
+    STREAMCOM_TASK_BEGIN(task);
+    for (task->counter = 0; task->counter < 4; task->counter++)
+    {
+        STREAMCOM_TASK_WAIT_WRITE(task, stream, 8);
+        stream->println((unsigned long)task->counter);
+        STREAMCOM_TASK_DELAY(task, 2);
+    }
+    STREAMCOM_TASK_END(task);
+}
+
+static Service_t services[] = {
+    {"LEVEL", {&level, &gain}, {I32, F}, 2, printLevel, ACCESS_PUBLIC, levelConstraints},
+    {"NAME", {name}, {STR}, 1, NULL, ACCESS_PUBLIC, NULL, SERVICE_DEFERRED},
+    {"MODE", {mode}, {STR}, 1, NULL, ACCESS_PUBLIC, modeConstraints},
+    {"SPEED", {&speed}, {I16}, 1, NULL, ACCESS_PUBLIC, NULL, SERVICE_INLINE, 50},
+    {"COUNT", {NULL}, {NONE}, 0, NULL, ACCESS_PUBLIC, NULL, 0, 0, countTask}};
+
+/*Each command is sent, then the loop runs until the tasks and rate limits are done*/
+static const char *const commands[] = {
+    "LEVEL=42;1.5\n",
+    "LEVEL=500;1\n",
+    "NAME=pump\n",
+    "NAME=0123456789012345678901234567890123456789012345678901234567890123456789\n",
+    "MODE=AUTO\n",
+    "MODE=FAST\n",
+    "SPEED=1\n",
+    "SPEED=2\n",
+    "COUNT\n",
+    "HELP\n",
+    "CATALOG\n",
+    "HASH\n",
+    "SIZE\n",
+    "MEM\n",
+#if STREAM_COM_AUTH_ENABLE == true
+    "AUTH\n",
+    "LOGIN=00\n",
+    "LOGOUT\n",
+#endif
+    "UNKNOWN=1\n",
+    "\n"};
+
+int main(void)
+{
+    HostStream stream;
+    stream.room = 64; /*Paced output, so the tasks yield*/
+    StreamCom streamCom;
+
+    counting = true;
+    streamCom.init(stream, services, sizeof(services) / sizeof(services[0]));
+
+    for (uint8_t round = 0; round < 3; round++)
+    {
+        for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
+        {
+            unsigned long before = allocations;
+            stream.feed(commands[i]);
+            for (uint8_t n = 0; n < 100; n++)
+            {
+                streamCom.loop();
+                stream.clearTx();
+                hostMicros += 1000;
+            }
+            if (allocations != before)
+            {
+                counting = false;
+                printf("FAIL: %lu allocations by %s", allocations - before, commands[i]);
+                return 1;
+            }
+        }
+    }
+    counting = false;
+
+    if (allocations != 0 || level != 42 || speed != 2 || strcmp(name, "pump") != 0 || strcmp(mode, "AUTO") != 0)
+    {
+        printf("FAIL: %lu allocations, level %ld, speed %d, name %s, mode %s\n", allocations, (long)level, speed, name, mode);
+        return 1;
+    }
+    printf("%zu commands, %zu bytes sent, 0 allocations\n", sizeof(commands) / sizeof(commands[0]), stream.txTotal);
+    return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * auth_test.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ *
+ * Host test of the challenge-response login (STREAM_COM_AUTH_ENABLE) and of the session timeout.
+ * See tools/host/Makefile.
+ */
+
+#include "StreamCom.h"
+
+#if STREAM_COM_AUTH_ENABLE != true
+#error "auth_test.cpp has to be built with STREAM_COM_AUTH_ENABLE=true"
+#endif
+
+static int failures = 0;
+
+#define CHECK(COND)                                                 \
+    do                                                              \
+    {                                                               \
+        if (!(COND))                                                \
+        {                                                           \
+            printf("FAIL: %s:%d: %s\n", __FILE__, __LINE__, #COND); \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+static const uint8_t authKey[] = {'s', 'e', 'c', 'r', 'e', 't'};
+static uint16_t secretCalls;
+
+static void secret(Stream *stream, void *args, uint32_t nParams)
+{
+    secretCalls++;
+}
+
+/*Sends a line and returns the response*/
+static const char *command(StreamCom &streamCom, HostStream &stream, const char *line)
+{
+    stream.clearTx();
+    stream.feed(line);
+    stream.feed("\n");
+    while (stream.available() > 0)
+    {
+        streamCom.loop(); /*Up to STREAM_COM_RX_BUDGET bytes per loop*/
+    }
+    stream.tx[(stream.txLen < sizeof(stream.tx)) ? stream.txLen : sizeof(stream.tx) - 1] = '\0';
+    return stream.tx;
+}
+
+/*Requests a challenge and answers it with the HMAC of the key*/
+static const char *login(StreamCom &streamCom, HostStream &stream, const uint8_t *key, size_t keyLen)
+{
+    const char *response = strstr(command(streamCom, stream, "AUTH"), "CHALLENGE: ");
+    uint8_t challenge[STREAM_COM_AUTH_CHALLENGE_SIZE];
+    uint8_t mac[STREAM_COM_SHA256_DIGEST_SIZE];
+    char line[8 + 2 * STREAM_COM_SHA256_DIGEST_SIZE];
+
+    if (response == NULL)
+    {
+        return "";
+    }
+    response += strlen("CHALLENGE: ");
+    for (uint8_t i = 0; i < STREAM_COM_AUTH_CHALLENGE_SIZE; i++)
+    {
+        char hex[3] = {response[2 * i], response[2 * i + 1], '\0'};
+        challenge[i] = (uint8_t)strtoul(hex, NULL, 16);
+    }
+    StreamCom_hmacSha256(key, keyLen, challenge, sizeof(challenge), mac);
+
+    strcpy(line, "LOGIN=");
+    for (uint8_t i = 0; i < STREAM_COM_SHA256_DIGEST_SIZE; i++)
+    {
+        snprintf(&line[6 + 2 * i], 3, "%02x", mac[i]);
+    }
+    return command(streamCom, stream, line);
+}
+
+int main(void)
+{
+    Service_t services[] = {{"SECRET", {NULL}, {NONE}, 0, secret, ACCESS_ADMIN}};
+    const uint8_t wrongKey[] = {'w', 'r', 'o', 'n', 'g'};
+    HostStream stream;
+    StreamCom streamCom;
+    streamCom.init(stream, services, 1);
+    streamCom.setAuthKey(authKey, sizeof(authKey), ACCESS_ADMIN);
+
+    CHECK(strstr(command(streamCom, stream, "SECRET"), "ACCESS DENIED") != NULL);
+    CHECK(strstr(login(streamCom, stream, wrongKey, sizeof(wrongKey)), "LOGIN: Failed") != NULL);
+    CHECK(secretCalls == 0);
+
+    /*A valid response grants the access level of the key*/
+    CHECK(strstr(login(streamCom, stream, authKey, sizeof(authKey)), "LOGIN: OK") != NULL);
+    command(streamCom, stream, "SECRET");
+    CHECK(secretCalls == 1);
+
+    /*Each command restarts the session timeout*/
+    hostMicros += (STREAM_COM_AUTH_SESSION_TIMEOUT_MS - 1) * 1000ul;
+    command(streamCom, stream, "SECRET");
+    CHECK(secretCalls == 2);
+
+    /*An idle session falls back to ACCESS_PUBLIC*/
+    hostMicros += STREAM_COM_AUTH_SESSION_TIMEOUT_MS * 1000ul;
+    CHECK(strstr(command(streamCom, stream, "SECRET"), "ACCESS DENIED") != NULL);
+    CHECK(secretCalls == 2);
+
+    /*LOGOUT drops the session at once*/
+    CHECK(strstr(login(streamCom, stream, authKey, sizeof(authKey)), "LOGIN: OK") != NULL);
+    command(streamCom, stream, "LOGOUT");
+    CHECK(strstr(command(streamCom, stream, "SECRET"), "ACCESS DENIED") != NULL);
+
+    if (failures != 0)
+    {
+        return 1;
+    }
+    printf("auth ok\n");
+    return 0;
+}
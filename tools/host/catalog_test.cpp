@@ -0,0 +1,86 @@
+/*
+ * catalog_test.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ *
+ * Host test of the signature table of the catalog. The table is updated incrementally by addService() and
+ * deleteService(), after each change the catalog has to match the one of an instance built from scratch.
+ * See tools/host/Makefile.
+ */
+
+#include "StreamCom.h"
+#include <string>
+#include <vector>
+
+#define POOL_SIZE 40u
+
+static Service_t pool[POOL_SIZE];
+static char tokens[POOL_SIZE][8];
+
+static std::string catalog(StreamCom &streamCom)
+{
+    HostStream stream;
+    StreamComTask_t task = StreamComTask_t();
+    while (streamCom.printCatalogPaced(stream, &task) != TASK_DONE)
+    {
+    }
+    return std::string(stream.tx, stream.txLen);
+}
+
+int main(void)
+{
+    const Types_e types[] = {I8, I16, F};
+    srand(3);
+    for (uint8_t i = 0; i < POOL_SIZE; i++)
+    {
+        snprintf(tokens[i], sizeof(tokens[i]), "S%02u", i);
+        pool[i] = {tokens[i], {NULL}, {NONE, NONE, NONE, NONE}, (uint32_t)(rand() % 3), NULL};
+        for (uint8_t j = 0; j < pool[i].nParams; j++)
+        {
+            pool[i].paramTypes[j] = types[rand() % 3];
+        }
+    }
+
+    HostStream stream;
+    StreamCom streamCom;
+    std::vector<Service_t *> services;
+    streamCom.init(stream, pool, 0);
+
+    for (uint16_t step = 0; step < 2000; step++)
+    {
+        if (services.empty() || (services.size() < 24 && rand() % 2))
+        {
+            Service_t *service = &pool[rand() % POOL_SIZE];
+            bool known = false;
+            for (size_t i = 0; i < services.size(); i++)
+            {
+                known |= (services[i] == service);
+            }
+            if (known == false)
+            {
+                streamCom.addService(*service);
+                services.push_back(service);
+            }
+        }
+        else
+        {
+            size_t idx = rand() % services.size();
+            streamCom.deleteService(services[idx]->token);
+            services.erase(services.begin() + idx);
+        }
+
+        StreamCom expected;
+        for (size_t i = 0; i < services.size(); i++)
+        {
+            expected.addService(*services[i]);
+        }
+        if (catalog(streamCom) != catalog(expected))
+        {
+            printf("FAIL: catalog differs after step %u\n%s---\n%s", step, catalog(streamCom).c_str(), catalog(expected).c_str());
+            return 1;
+        }
+    }
+    printf("catalog ok\n");
+    return 0;
+}
@@ -0,0 +1,121 @@
+/*
+ * coro_test.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ *
+ * Host test of the C++20 coroutine tasks (STREAM_COM_COROUTINE_SUPPORT). It is built with -std=c++20, the
+ * other host targets use C++17 and do not compile the coroutine path. See tools/host/Makefile.
+ */
+
+#include "StreamCom.h"
+
+#if STREAM_COM_COROUTINE_SUPPORT != true
+#error "coro_test.cpp has to be built with C++20 coroutines and without STREAM_COM_STATIC_ALLOCATION"
+#endif
+
+static int failures = 0;
+
+#define CHECK(COND)                                                 \
+    do                                                              \
+    {                                                               \
+        if (!(COND))                                                \
+        {                                                           \
+            printf("FAIL: %s:%d: %s\n", __FILE__, __LINE__, #COND); \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+static int frames = 0;
+static int steps = 0;
+
+/** Lives in the coroutine frame, so the frames which are not destroyed can be counted. */
+struct FrameGuard
+{
+    FrameGuard(void) { frames++; }
+    ~FrameGuard(void) { frames--; }
+};
+
+static StreamComCoroutine sweep(Stream *stream, void *args, uint32_t nParams)
+{
+    FrameGuard guard;
+    for (int i = 0; i < 3; i++)
+    {
+        co_await StreamComWaitWrite{stream, 8};
+        stream->println(i);
+        steps++;
+        co_await StreamComDelay{10};
+    }
+    co_await StreamComYield{};
+    steps++;
+}
+STREAMCOM_COROUTINE_TASK(sweepTask, sweep)
+
+static void loop(StreamCom &streamCom, uint16_t n, unsigned long stepUs)
+{
+    while (n--)
+    {
+        streamCom.loop();
+        hostMicros += stepUs;
+    }
+}
+
+/*The coroutine runs to its end and its frame is destroyed*/
+static void testCompletion(void)
+{
+    Service_t services[] = {{"SWEEP", {NULL}, {NONE}, 0, NULL, ACCESS_PUBLIC, NULL, 0, 0, sweepTask}};
+    HostStream stream;
+    StreamCom streamCom;
+    streamCom.init(stream, services, 1);
+
+    steps = 0;
+    stream.feed("SWEEP\n");
+    loop(streamCom, 3, 1000);
+    CHECK(frames == 1);
+    CHECK(steps == 1); /*Waits for the delay of 10 ms*/
+
+    loop(streamCom, 100, 1000);
+    CHECK(steps == 4);
+    CHECK(frames == 0);
+    stream.tx[stream.txLen] = '\0';
+    CHECK(strstr(stream.tx, "0\r\n1\r\n2\r\n") != NULL);
+
+    /*The slot is free again, the task can be started once more*/
+    stream.feed("SWEEP\n");
+    loop(streamCom, 100, 1000);
+    CHECK(steps == 8);
+    CHECK(frames == 0);
+}
+
+/*detach() cancels the running coroutine of the stream and destroys its frame*/
+static void testDetach(void)
+{
+    Service_t services[] = {{"SWEEP", {NULL}, {NONE}, 0, NULL, ACCESS_PUBLIC, NULL, 0, 0, sweepTask}};
+    HostStream stream1;
+    HostStream stream2;
+    StreamCom streamCom;
+    streamCom.init(stream1, services, 1);
+    CHECK(streamCom.attach(stream2));
+
+    steps = 0;
+    stream2.feed("SWEEP\n");
+    loop(streamCom, 3, 1000);
+    CHECK(frames == 1);
+
+    streamCom.detach(stream2);
+    CHECK(frames == 0);
+    loop(streamCom, 100, 1000);
+    CHECK(steps == 1);
+}
+
+int main(void)
+{
+    testCompletion();
+    testDetach();
+    if (failures != 0)
+    {
+        return 1;
+    }
+    printf("coroutine ok\n");
+    return 0;
+}
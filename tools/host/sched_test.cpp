@@ -0,0 +1,178 @@
+/*
+ * sched_test.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ *
+ * Host test of the scheduler of deferred callbacks and tasks. See tools/host/Makefile.
+ */
+
+#include "StreamCom.h"
+
+static int failures = 0;
+
+#define CHECK(COND)                                            \
+    do                                                         \
+    {                                                          \
+        if (!(COND))                                           \
+        {                                                      \
+            printf("FAIL: %s:%d: %s\n", __FILE__, __LINE__, #COND); \
+            failures++;                                        \
+        }                                                      \
+    } while (0)
+
+static uint16_t steps[3];
+
+static TaskState_e stepTask(uint8_t idx, StreamComTask_t *task)
+{
+    STREAMCOM_TASK_BEGIN(task);
+    for (task->counter = 0; task->counter < 1000; task->counter++)
+    {
+        steps[idx]++;
+        STREAMCOM_TASK_YIELD(task);
+    }
+    STREAMCOM_TASK_END(task);
+}
+static TaskState_e taskA(Stream *stream, void *args, uint32_t nParams, StreamComTask_t *task) { return stepTask(0, task); }
+static TaskState_e taskB(Stream *stream, void *args, uint32_t nParams, StreamComTask_t *task) { return stepTask(1, task); }
+static TaskState_e taskC(Stream *stream, void *args, uint32_t nParams, StreamComTask_t *task) { return stepTask(2, task); }
+
+static int16_t taskValue;
+static int16_t seenValue;
+
+static TaskState_e valueTask(Stream *stream, void *args, uint32_t nParams, StreamComTask_t *task)
+{
+    STREAMCOM_TASK_BEGIN(task);
+    for (task->counter = 0; task->counter < 5; task->counter++)
+    {
+        seenValue = taskValue;
+        STREAMCOM_TASK_YIELD(task);
+    }
+    STREAMCOM_TASK_END(task);
+}
+
+static void loop(StreamCom &streamCom, HostStream &stream, uint16_t n)
+{
+    while (n--)
+    {
+        streamCom.loop();
+        stream.clearTx();
+        hostMicros += 1000;
+    }
+}
+
+/*Each running task is resumed once per loop, none is skipped or resumed twice*/
+static void testRoundRobin(void)
+{
+    Service_t services[] = {
+        {"A", {NULL}, {NONE}, 0, NULL, ACCESS_PUBLIC, NULL, 0, 0, taskA},
+        {"B", {NULL}, {NONE}, 0, NULL, ACCESS_PUBLIC, NULL, 0, 0, taskB},
+        {"C", {NULL}, {NONE}, 0, NULL, ACCESS_PUBLIC, NULL, 0, 0, taskC}};
+    HostStream stream;
+    StreamCom streamCom;
+    streamCom.init(stream, services, 3);
+
+    stream.feed("A\nB\nC\n");
+    loop(streamCom, stream, 3);
+    memset(steps, 0, sizeof(steps));
+    loop(streamCom, stream, 10);
+    CHECK(steps[0] == 10);
+    CHECK(steps[1] == 10);
+    CHECK(steps[2] == 10);
+}
+
+/*A command rejected with SCHEDULER QUEUE FULL does not write its variables*/
+static void testQueueFull(void)
+{
+    int16_t wait[STREAM_COM_SCHEDULER_SIZE] = {0};
+    int16_t value = 0;
+    Service_t services[STREAM_COM_SCHEDULER_SIZE + 1];
+    const char *tokens[] = {"W0", "W1", "W2", "W3", "W4", "W5", "W6", "W7"};
+    for (uint8_t i = 0; i < STREAM_COM_SCHEDULER_SIZE; i++)
+    {
+        services[i] = {tokens[i], {&wait[i]}, {I16}, 1, NULL, ACCESS_PUBLIC, NULL, SERVICE_DEBOUNCE, 1000};
+    }
+    services[STREAM_COM_SCHEDULER_SIZE] = {"V", {&value}, {I16}, 1, NULL, ACCESS_PUBLIC, NULL, SERVICE_DEFERRED};
+    HostStream stream;
+    StreamCom streamCom;
+    streamCom.init(stream, services, STREAM_COM_SCHEDULER_SIZE + 1);
+
+    for (uint8_t i = 0; i < STREAM_COM_SCHEDULER_SIZE; i++)
+    {
+        stream.feed(tokens[i]);
+        stream.feed("=1\n");
+        loop(streamCom, stream, 1);
+    }
+    stream.feed("V=7\n");
+    streamCom.loop();
+    stream.tx[stream.txLen] = '\0';
+    CHECK(strstr(stream.tx, "SCHEDULER QUEUE FULL") != NULL);
+    CHECK(value == 0);
+    stream.clearTx();
+}
+
+/*A command rejected with SERVICE BUSY does not write the variables of the running task*/
+static void testBusy(void)
+{
+    Service_t services[] = {{"V", {&taskValue}, {I16}, 1, NULL, ACCESS_PUBLIC, NULL, 0, 0, valueTask}};
+    HostStream stream;
+    StreamCom streamCom;
+    streamCom.init(stream, services, 1);
+
+    stream.feed("V=1\n");
+    loop(streamCom, stream, 2);
+    stream.feed("V=99\n");
+    streamCom.loop();
+    stream.tx[stream.txLen] = '\0';
+    CHECK(strstr(stream.tx, "SERVICE BUSY") != NULL);
+    CHECK(taskValue == 1);
+    loop(streamCom, stream, 10);
+    CHECK(seenValue == 1);
+
+    /*Once the task is done, the next command is accepted*/
+    stream.feed("V=99\n");
+    loop(streamCom, stream, 10);
+    CHECK(seenValue == 99);
+}
+
+static uint16_t rateCalls;
+
+static void countCall(Stream *stream, void *args, uint32_t nParams)
+{
+    rateCalls++;
+}
+
+/*The rate limit is kept per instance, a shared service table does not couple the instances*/
+static void testSharedRateLimit(void)
+{
+    int16_t value = 0;
+    Service_t services[] = {{"R", {&value}, {I16}, 1, countCall, ACCESS_PUBLIC, NULL, SERVICE_INLINE, 1000}};
+    HostStream stream1;
+    HostStream stream2;
+    StreamCom streamCom1;
+    StreamCom streamCom2;
+    streamCom1.init(stream1, services, 1);
+    streamCom2.init(stream2, services, 1);
+
+    rateCalls = 0;
+    stream1.feed("R=1\n");
+    loop(streamCom1, stream1, 2);
+    CHECK(rateCalls == 1);
+    stream2.feed("R=2\n");
+    loop(streamCom2, stream2, 2);
+    CHECK(rateCalls == 2);
+}
+
+int main(void)
+{
+    testRoundRobin();
+    testQueueFull();
+    testBusy();
+    testSharedRateLimit();
+    if (failures != 0)
+    {
+        return 1;
+    }
+    printf("scheduler ok\n");
+    return 0;
+}
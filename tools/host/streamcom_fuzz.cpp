@@ -0,0 +1,279 @@
+/*
+ * streamcom_fuzz.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ *
+ * Fuzz harness of the StreamCom parser. The first byte of the input selects the generated service
+ * table, the other bytes are received by the stream:
+ *
+ *   bit 0-1  parameter types of SET
+ *   bit 2    SET has constraints
+ *   bit 3    SET is deferred
+ *   bit 4    the stream uses COBS framing (STREAM_COM_FRAMING_ENABLE)
+ *   bit 5    the stream reports 8 bytes free TX space, so the output is paced
+ *   bit 6    RATE is debounced instead of rate limited
+ *   bit 7    RATE uses a long interval
+ *
+ * Built with libFuzzer (make fuzz) or as standalone driver which runs the corpus and random mutations
+ * of it (make run). See tools/host/Makefile.
+ */
+
+#include "StreamCom.h"
+#include <dirent.h>
+#include <vector>
+
+static int8_t i8;
+static int16_t i16;
+static int32_t i32;
+static int64_t i64;
+static float f;
+static float f2;
+static double d;
+#if STREAM_COM_STATIC_ALLOCATION == true
+static char str[STREAM_COM_STRING_SIZE];
+#else
+static String str;
+#endif
+static int16_t rate;
+
+static const Types_e typeSets[4][STREAM_COM_MAX_PARAMETER] = {
+    {I32, F, F, NONE},
+    {I8, I16, STR, NONE},
+    {I64, D, I32, I8},
+    {STR, RAW, D, NONE}};
+static void *const paramSets[4][STREAM_COM_MAX_PARAMETER] = {
+    {&i32, &f, &f2, NULL},
+    {&i8, &i16, &str, NULL},
+    {&i64, &d, &i32, &i8},
+    {&str, NULL, &d, NULL}};
+static const uint32_t paramCounts[4] = {3, 3, 4, 3};
+static const Constraint_t constraintSets[4][STREAM_COM_MAX_PARAMETER] = {
+    {STREAMCOM_RANGE(0, 1000), STREAMCOM_RANGE(0.0, 10.0), STREAMCOM_ONE_OF("0.5|1|2.5"), STREAMCOM_NO_CHECK},
+    {STREAMCOM_ONE_OF("1|5|10"), STREAMCOM_RANGE(-100, 100), STREAMCOM_PATTERN("##:##"), STREAMCOM_NO_CHECK},
+    {STREAMCOM_RANGE(-1e12, 1e12), STREAMCOM_RANGE(-1.0, 1.0), STREAMCOM_NO_CHECK, STREAMCOM_RANGE(0, 3)},
+    {STREAMCOM_ONE_OF("ON|OFF|AUTO"), STREAMCOM_MAX_LEN(4), STREAMCOM_PATTERN("*\\**"), STREAMCOM_NO_CHECK}};
+
+static const uint8_t authKey[] = {'f', 'u', 'z', 'z'};
+
+static void printValues(Stream *stream, void *args, uint32_t nParams)
+{
+    stream->print(i32);
+    stream->print(';');
+    stream->print(f, 3);
+    stream->print(';');
+    stream->print((long)i64);
+    stream->print(';');
+    stream->println(d, 6);
+}
+
+static TaskState_e stepTask(Stream *stream, void *args, uint32_t nParams, StreamComTask_t *task)
+{
+    STREAMCOM_TASK_BEGIN(task);
+    for (task->counter = 0; task->counter < 3; task->counter++)
+    {
+        STREAMCOM_TASK_WAIT_WRITE(task, stream, 8);
+        stream->println((unsigned long)task->counter);
+        STREAMCOM_TASK_DELAY(task, 5);
+    }
+    STREAMCOM_TASK_END(task);
+}
+
+/*Values which pass the validation must be finite and within the constraints*/
+static void checkValues(uint8_t config)
+{
+    if (isnan(f) || isinf(f) || isnan(f2) || isinf(f2) || isnan(d) || isinf(d))
+    {
+        abort();
+    }
+    if ((config & 0x07) == 0x04 && (i32 < 0 || i32 > 1000 || f < 0.0f || f > 10.0f))
+    {
+        abort();
+    }
+    if ((config & 0x07) == 0x06 && (i64 < -1000000000000LL || i64 > 1000000000000LL || d < -1.0 || d > 1.0))
+    {
+        abort();
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size < 1)
+    {
+        return 0;
+    }
+    uint8_t config = data[0];
+    uint8_t set = config & 0x03;
+
+    Service_t services[4] = {
+        {"SET", {NULL}, {NONE}, paramCounts[set], printValues, ACCESS_PUBLIC, (config & 0x04) ? constraintSets[set] : NULL,
+         (uint8_t)((config & 0x08) ? SERVICE_DEFERRED : SERVICE_INLINE)},
+        {"RATE", {&rate}, {I16}, 1, printValues, ACCESS_PUBLIC, NULL,
+         (uint8_t)((config & 0x40) ? SERVICE_DEBOUNCE : SERVICE_INLINE), (uint16_t)((config & 0x80) ? 500 : 3)},
+        {"STEP", {NULL}, {NONE}, 0, NULL, ACCESS_PUBLIC, NULL, 0, 0, stepTask},
+        {"ADMIN", {&i32}, {I32}, 1, printValues, ACCESS_ADMIN}};
+    for (uint8_t i = 0; i < STREAM_COM_MAX_PARAMETER; i++)
+    {
+        services[0].params[i] = paramSets[set][i];
+        services[0].paramTypes[i] = typeSets[set][i];
+    }
+
+    i32 = 0;
+    i64 = 0;
+    f = 0;
+    f2 = 0;
+    d = 0;
+
+    HostStream stream;
+    stream.room = (config & 0x20) ? 8 : 0;
+
+    StreamCom streamCom;
+    streamCom.init(stream, services, 4);
+#if STREAM_COM_FRAMING_ENABLE == true
+    if (config & 0x10)
+    {
+        streamCom.setFraming(stream, FRAMING_COBS);
+    }
+#endif
+#if STREAM_COM_AUTH_ENABLE == true
+    streamCom.setAuthKey(authKey, sizeof(authKey));
+#endif
+
+    /*Feed the input in small chunks, like a real UART*/
+    size_t pos = 1;
+    while (pos < size)
+    {
+        size_t chunk = size - pos < 16 ? size - pos : 16;
+        pos += stream.feed(&data[pos], chunk);
+        streamCom.loop();
+        checkValues(config);
+        stream.clearTx();
+        hostMicros += 137;
+    }
+
+    /*Let the line timeout, the rate limits and the tasks run out*/
+    for (uint8_t i = 0; i < 60; i++)
+    {
+        streamCom.loop();
+        checkValues(config);
+        stream.clearTx();
+        hostMicros += 20000;
+    }
+    return 0;
+}
+
+#ifdef STREAMCOM_FUZZ_MAIN
+static bool readFile(const char *path, std::vector<uint8_t> &input)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    input.clear();
+    int c;
+    while ((c = fgetc(file)) != EOF)
+    {
+        input.push_back((uint8_t)c);
+    }
+    fclose(file);
+    return true;
+}
+
+/*
+ * Standalone driver for compilers without libFuzzer:
+ *   streamcom_fuzz [-runs=N] [-seed=S] <file or directory>...
+ * Runs each input once, then N random mutations of the inputs.
+ */
+int main(int argc, char **argv)
+{
+    std::vector<std::vector<uint8_t>> corpus;
+    unsigned long runs = 0;
+    unsigned int seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "-runs=", 6) == 0)
+        {
+            runs = strtoul(argv[i] + 6, NULL, 10);
+            continue;
+        }
+        if (strncmp(argv[i], "-seed=", 6) == 0)
+        {
+            seed = strtoul(argv[i] + 6, NULL, 10);
+            continue;
+        }
+
+        DIR *dir = opendir(argv[i]);
+        std::vector<uint8_t> input;
+        if (dir == NULL)
+        {
+            if (readFile(argv[i], input))
+            {
+                corpus.push_back(input);
+            }
+            continue;
+        }
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL)
+        {
+            std::string path = std::string(argv[i]) + "/" + entry->d_name;
+            if (entry->d_name[0] != '.' && readFile(path.c_str(), input))
+            {
+                corpus.push_back(input);
+            }
+        }
+        closedir(dir);
+    }
+
+    for (size_t i = 0; i < corpus.size(); i++)
+    {
+        LLVMFuzzerTestOneInput(corpus[i].data(), corpus[i].size());
+    }
+    printf("%zu inputs\n", corpus.size());
+
+    srand(seed);
+    for (unsigned long run = 0; run < runs && !corpus.empty(); run++)
+    {
+        std::vector<uint8_t> input = corpus[rand() % corpus.size()];
+        int mutations = 1 + rand() % 8;
+        while (mutations--)
+        {
+            size_t at = input.empty() ? 0 : rand() % input.size();
+            switch (rand() % 4)
+            {
+            case 0:
+                input.insert(input.begin() + at, (uint8_t)rand());
+                break;
+            case 1:
+                if (!input.empty())
+                {
+                    input.erase(input.begin() + at);
+                }
+                break;
+            case 2:
+                if (!input.empty())
+                {
+                    input[at] ^= (uint8_t)(1 << (rand() % 8));
+                }
+                break;
+            default:
+            {
+                /*Splice a part of another input*/
+                const std::vector<uint8_t> &other = corpus[rand() % corpus.size()];
+                size_t from = other.empty() ? 0 : rand() % other.size();
+                size_t len = rand() % 32;
+                for (size_t k = 0; k < len && from + k < other.size(); k++)
+                {
+                    input.insert(input.begin() + (at + k > input.size() ? input.size() : at + k), other[from + k]);
+                }
+                break;
+            }
+            }
+        }
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    printf("%lu mutations\n", runs);
+    return 0;
+}
+#endif
@@ -0,0 +1,191 @@
+/*
+ * streamcom_replay_host.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: c.seidel
+ *
+ * Host replay driver of tools/streamcom_replay.py (--host). It feeds the lines of a trace dump into a
+ * HostStream with the recorded timing and prints the new trace of the host build:
+ *
+ *   streamcom_replay_host [-speed=S] trace.txt > host_trace.txt
+ *
+ * The time follows the clock of the PC (hostRealTime), so the durations are real. The firmware's service
+ * table is not known, each token of the trace becomes a service with RAW parameters and without callback.
+ * So the replay measures the parser and the dispatch of the library, not the callbacks.
+ */
+
+#include "StreamCom.h"
+
+#if STREAM_COM_TRACE_ENABLE != true
+#error "streamcom_replay_host.cpp has to be built with STREAM_COM_TRACE_ENABLE=true"
+#endif
+
+#define REPLAY_MAX_RECORDS 4096u
+#define REPLAY_MAX_SERVICES 64u
+
+typedef struct
+{
+    unsigned long timestamp;
+    char line[STREAM_COM_LINE_BUFFER_SIZE];
+} Record_t;
+
+/** Prints to stdout. */
+class StdoutPrint : public Print
+{
+public:
+    size_t write(uint8_t data) { return fputc(data, stdout) == EOF ? 0 : 1; }
+};
+
+static Record_t records[REPLAY_MAX_RECORDS];
+static uint16_t nRecords = 0;
+static Service_t services[REPLAY_MAX_SERVICES];
+static char tokens[REPLAY_MAX_SERVICES][STREAM_COM_LINE_BUFFER_SIZE];
+static uint16_t nServices = 0;
+
+/*Reads the records of the last dump in the file, without the trace services*/
+static bool readTrace(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    char line[STREAM_COM_LINE_BUFFER_SIZE + 64];
+    bool inside = false;
+
+    if (file == NULL)
+    {
+        return false;
+    }
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (strncmp(line, "#TRACE", 6) == 0)
+        {
+            inside = true;
+            nRecords = 0;
+            continue;
+        }
+        if (strncmp(line, "#END", 4) == 0)
+        {
+            inside = false;
+            continue;
+        }
+
+        /*<timestamp>;<duration>;<connection>;<result>;<line>*/
+        char *text = line;
+        for (uint8_t i = 0; i < 4 && text != NULL; i++)
+        {
+            text = strchr(text, ';');
+            text = (text != NULL) ? text + 1 : NULL;
+        }
+        if (inside == false || text == NULL || nRecords >= REPLAY_MAX_RECORDS)
+        {
+            continue;
+        }
+        size_t tokenLen = strcspn(text, STREAM_COM_CDM_DELIMITER);
+        if ((tokenLen == 5 && strncmp(text, "TRACE", 5) == 0) || (tokenLen == 9 && strncmp(text, "TRACE_CLR", 9) == 0))
+        {
+            continue;
+        }
+        records[nRecords].timestamp = strtoul(line, NULL, 10);
+        snprintf(records[nRecords].line, sizeof(records[nRecords].line), "%s", text);
+        nRecords++;
+    }
+    fclose(file);
+    return true;
+}
+
+/*Adds a service for each token, the number of parameters is taken from its first record*/
+static void addServices(StreamCom &streamCom)
+{
+    for (uint16_t i = 0; i < nRecords && nServices < REPLAY_MAX_SERVICES; i++)
+    {
+        char *token = tokens[nServices];
+        snprintf(token, sizeof(tokens[0]), "%s", records[i].line);
+        char *params = strstr(token, STREAM_COM_CDM_DELIMITER);
+        uint32_t nParams = 0;
+        if (params != NULL)
+        {
+            *params = '\0';
+            params += strlen(STREAM_COM_CDM_DELIMITER);
+            for (nParams = 1; nParams < STREAM_COM_MAX_PARAMETER && (params = strstr(params, STREAM_COM_PARAM_DELIMITER)) != NULL; nParams++)
+            {
+                params += strlen(STREAM_COM_PARAM_DELIMITER);
+            }
+        }
+        bool known = (token[0] == '\0');
+        for (uint16_t j = 0; j < nServices && known == false; j++)
+        {
+            known = (strcmp(tokens[j], token) == 0);
+        }
+        if (known)
+        {
+            continue;
+        }
+
+        Service_t &service = services[nServices++];
+        service = {token, {NULL}, {NONE, NONE, NONE, NONE}, nParams, NULL};
+        for (uint8_t j = 0; j < nParams; j++)
+        {
+            service.paramTypes[j] = RAW;
+        }
+        /*Tokens of the default services are ignored by addService()*/
+        streamCom.addService(service);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    double speed = 1.0;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "-speed=", 7) == 0)
+        {
+            speed = strtod(argv[i] + 7, NULL);
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+    if (path == NULL || readTrace(path) == false)
+    {
+        fprintf(stderr, "usage: streamcom_replay_host [-speed=S] trace.txt\n");
+        return 2;
+    }
+
+    HostStream stream;
+    StreamCom streamCom;
+    StdoutPrint out;
+    hostRealTime = true;
+    streamCom.init(stream, services, 0);
+    addServices(streamCom);
+    streamCom.clearTrace();
+
+    unsigned long start = micros();
+    for (uint16_t i = 0; i < nRecords; i++)
+    {
+        if (speed > 0)
+        {
+            unsigned long due = (unsigned long)((records[i].timestamp - records[0].timestamp) * 1000.0 / speed);
+            while (micros() - start < due)
+            {
+                streamCom.loop();
+                stream.clearTx();
+            }
+        }
+        stream.feed(records[i].line);
+        stream.feed("\n");
+        while (stream.available() > 0)
+        {
+            streamCom.loop();
+            stream.clearTx();
+        }
+    }
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        streamCom.loop();
+    }
+
+    streamCom.dumpTrace(out);
+    return 0;
+}
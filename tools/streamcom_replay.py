@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+"""
+streamcom_replay.py
+
+Replays a StreamCom trace (output of the TRACE service) against a device and
+compares the dispatch duration of each command with a baseline trace.
+
+Usage:
+    streamcom_replay.py trace.txt --tcp 192.168.0.10:23
+    streamcom_replay.py trace.txt --serial /dev/ttyUSB0 --baud 115200 --speed 4
+    streamcom_replay.py trace.txt --serial /dev/ttyUSB0 --baseline old.txt --threshold 20
+    streamcom_replay.py trace.txt --host tools/host/streamcom_replay_host --baseline host_old.txt
+
+The device needs STREAM_COM_TRACE_ENABLE. The tool clears the trace on the
+device, sends the recorded lines with the recorded timing (divided by --speed,
+0 sends as fast as possible), reads the new trace back and reports each command
+whose duration grew by more than --threshold percent. The exit code is 1 if a
+regression was found. The responses of the device are read by a background
+thread, so reading never delays the next command.
+
+With --host, the trace is replayed through the host build of the library
+(tools/host, make replay) instead of a device. The host driver only knows the
+tokens of the trace, so it measures the parser and the dispatch, not the
+callbacks of the firmware. Its output is a trace dump, which can be saved as
+baseline of a later host run.
+"""
+
+import argparse
+import socket
+import subprocess
+import sys
+import threading
+import time
+
+TRACE_SERVICES = ("TRACE", "TRACE_CLR")
+
+
+def parse_trace(lines):
+    """Returns the records of a trace dump as list of dicts."""
+    records = []
+    inside = False
+    for line in lines:
+        line = line.rstrip("\r\n")
+        if line.startswith("#TRACE"):
+            inside = True
+            records = []
+        elif line.startswith("#END"):
+            inside = False
+        elif inside:
+            fields = line.split(";", 4)
+            if len(fields) != 5:
+                continue
+            records.append({
+                "timestamp": int(fields[0]),
+                "duration": int(fields[1]),
+                "connection": int(fields[2]),
+                "result": int(fields[3]),
+                "line": fields[4],
+            })
+    return [r for r in records if r["line"].split("=", 1)[0] not in TRACE_SERVICES]
+
+
+class TcpLink:
+    def __init__(self, address):
+        host, port = address.rsplit(":", 1)
+        self.sock = socket.create_connection((host, int(port)), timeout=5)
+        self.sock.settimeout(0.1)
+
+    def write(self, data):
+        self.sock.sendall(data)
+
+    def read(self):
+        try:
+            return self.sock.recv(4096)
+        except socket.timeout:
+            return b""
+
+
+class SerialLink:
+    def __init__(self, port, baud):
+        import serial  # pyserial
+
+        self.port = serial.Serial(port, baud, timeout=0.1)
+
+    def write(self, data):
+        self.port.write(data)
+
+    def read(self):
+        return self.port.read(4096)
+
+
+class Reader(threading.Thread):
+    """Collects the responses of the device in the background, the reads of the links block."""
+
+    def __init__(self, link):
+        super().__init__(daemon=True)
+        self.link = link
+        self.lock = threading.Lock()
+        self.data = b""
+        self.running = True
+
+    def run(self):
+        while self.running:
+            data = self.link.read()
+            if data:
+                with self.lock:
+                    self.data += data
+
+    def take(self):
+        """Returns the data received so far without waiting."""
+        with self.lock:
+            data, self.data = self.data, b""
+        return data
+
+    def stop(self):
+        self.running = False
+        self.join()
+
+
+def send_line(link, line):
+    link.write(line.encode("latin-1") + b"\n")
+
+
+def read_trace(link, reader, timeout):
+    """Requests the trace of the device and waits for the complete dump."""
+    reader.take()
+    send_line(link, "TRACE")
+    data = b""
+    end = time.monotonic() + timeout
+    while time.monotonic() < end and b"#END" not in data:
+        time.sleep(0.01)
+        data += reader.take()
+    return parse_trace(data.decode("latin-1").splitlines())
+
+
+def replay(link, reader, records, speed):
+    send_line(link, "TRACE_CLR")
+    time.sleep(0.2)
+    reader.take()
+
+    start = time.monotonic()
+    first = records[0]["timestamp"] if records else 0
+    for record in records:
+        if speed > 0:
+            due = start + (record["timestamp"] - first) / 1000.0 / speed
+            delay = due - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+        send_line(link, record["line"])
+        reader.take()
+
+
+def replay_host(driver, trace, speed):
+    """Replays the trace through the host driver, which prints the new trace."""
+    output = subprocess.run([driver, "-speed=%g" % speed, trace], check=True, stdout=subprocess.PIPE).stdout
+    return parse_trace(output.decode("latin-1").splitlines())
+
+
+def compare(baseline, current, threshold):
+    regressions = 0
+    print("%-32s %10s %10s %8s" % ("command", "base [us]", "now [us]", "diff"))
+    for base, now in zip(baseline, current):
+        if base["line"] != now["line"]:
+            print("trace mismatch: '%s' != '%s'" % (base["line"], now["line"]))
+            return 1
+        diff = (now["duration"] - base["duration"]) * 100.0 / max(base["duration"], 1)
+        mark = ""
+        if diff > threshold:
+            mark = "  <-- REGRESSION"
+            regressions += 1
+        print("%-32s %10d %10d %7.1f%%%s" % (base["line"][:32], base["duration"], now["duration"], diff, mark))
+    if len(baseline) != len(current):
+        print("record count differs: baseline %d, now %d" % (len(baseline), len(current)))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Replay a StreamCom trace and compare the latency.")
+    parser.add_argument("trace", help="trace dump to replay")
+    parser.add_argument("--baseline", help="trace dump with the reference durations (default: trace)")
+    parser.add_argument("--tcp", help="host:port of the device (e.g. TelnetStream)")
+    parser.add_argument("--serial", help="serial port of the device")
+    parser.add_argument("--host", help="host replay driver (tools/host/streamcom_replay_host) instead of a device")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--speed", type=float, default=1.0, help="replay speed factor, 0 = no delay")
+    parser.add_argument("--threshold", type=float, default=20.0, help="allowed duration increase in percent")
+    parser.add_argument("--timeout", type=float, default=5.0, help="timeout for the trace download in s")
+    args = parser.parse_args()
+
+    with open(args.trace) as f:
+        records = parse_trace(f)
+    baseline = records
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = parse_trace(f)
+
+    if args.host:
+        current = replay_host(args.host, args.trace, args.speed)
+        return 1 if compare(baseline, current, args.threshold) else 0
+
+    if args.tcp:
+        link = TcpLink(args.tcp)
+    elif args.serial:
+        link = SerialLink(args.serial, args.baud)
+    else:
+        parser.error("either --tcp, --serial or --host is needed")
+
+    reader = Reader(link)
+    reader.start()
+    replay(link, reader, records, args.speed)
+    current = read_trace(link, reader, args.timeout)
+    reader.stop()
+    return 1 if compare(baseline, current, args.threshold) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())